@@ -355,28 +355,41 @@ Window {
         spacing: 4
         interactive: false
 
+        // 当前行的高亮进度：按播放时钟的同步点外推位置，每帧调用 C++ 计算，逐字歌词（yrc）按字推进
+        property real lineProgress: 0
+
+        function refreshLineProgress() {
+            if (!musicController || musicController.currentLyricIndex < 0) {
+                lineProgress = 0
+                return
+            }
+            const pos = Math.max(0, musicController.playbackClock.positionAt(Date.now()) + musicController.lyricOffsetMs)
+            lineProgress = musicController.lyricModel.highlightProgress(musicController.currentLyricIndex, pos, musicController.currentLyricNextMs)
+        }
+
+        FrameAnimation {
+            running: overlay.visible && musicController && musicController.playing && musicController.currentLyricIndex >= 0
+            onTriggered: lyricList.refreshLineProgress()
+        }
+
+        // 暂停时没有动画帧，跳转与偏移调整后的进度随同步点与换行刷新
+        Connections {
+            target: musicController ? musicController.playbackClock : null
+            function onSynced() { lyricList.refreshLineProgress() }
+        }
+
         delegate: Column {
             width: lyricList.width
             spacing: 2
 
             property bool current: musicController && index === musicController.currentLyricIndex
-            property real startMs: timeMs
-            property real nextMs: {
-                let i = index + 1
-                if (!musicController || i >= lyricList.count) return musicController ? musicController.durationMs : 0
-                // next line's time isn't directly readable here; fallback to controller property
-                return musicController.currentLyricNextMs
-            }
-            property real posMs: musicController ? (musicController.positionMs + musicController.lyricOffsetMs) : 0
-            property real progress: {
-                if (!current) return 0
-                const dur = Math.max(1, nextMs - startMs)
-                const p = (posMs - startMs) / dur
-                return Math.max(0, Math.min(1, p))
-            }
+            // 只有当前行读取逐帧更新的进度，其余行不受动画帧影响
+            property real progress: current ? lyricList.lineProgress : 0
+            property bool karaoke: current && model.wordTimed && lineText.lineCount === 1
 
             // 主歌词文本
             Text {
+                id: lineText
                 width: lyricList.width
                 text: model.text
                 color: current ? baseTextColor : secondaryTextColor
@@ -386,14 +399,51 @@ Window {
                 font.weight: current ? Font.DemiBold : Font.Normal
                 opacity: current ? 1.0 : 0.6
                 scale: current ? 1.05 : 1.0
+
+                // 逐字高亮：高亮色的同一行文本按进度裁剪
+                Item {
+                    visible: karaoke
+                    x: Math.round((lineText.width - lineText.contentWidth) / 2)
+                    width: Math.round(progress * lineText.contentWidth)
+                    height: lineText.height
+                    clip: true
+                    Text {
+                        width: lineText.contentWidth
+                        text: lineText.text
+                        color: highlightColor
+                        font: lineText.font
+                    }
+                }
+            }
+
+            // 音译与翻译随行显示，来自模型角色，无需额外解析
+            Text {
+                width: lyricList.width
+                visible: text.length > 0
+                text: model.romanization
+                color: secondaryTextColor
+                wrapMode: Text.Wrap
+                horizontalAlignment: Text.AlignHCenter
+                font.pixelSize: Math.round(fontSize * 0.7)
+                opacity: current ? 0.9 : 0.5
+            }
+            Text {
+                width: lyricList.width
+                visible: text.length > 0
+                text: model.translation
+                color: current ? baseTextColor : secondaryTextColor
+                wrapMode: Text.Wrap
+                horizontalAlignment: Text.AlignHCenter
+                font.pixelSize: Math.round(fontSize * 0.8)
+                opacity: current ? 0.9 : 0.5
             }
 
-            // 进度条替代渐变高亮
+            // 没有逐字时间时，用进度条表示行内进度
             Rectangle {
                 width: Math.round(progress * (lyricList.width * 0.6))
                 height: 3
                 color: highlightColor
-                visible: current
+                visible: current && !karaoke
                 anchors.horizontalCenter: parent.horizontalCenter
                 radius: 2
             }
@@ -403,6 +453,7 @@ Window {
             target: musicController
             function onCurrentLyricIndexChanged() {
                 if (!musicController) return
+                lyricList.refreshLineProgress()
                 if (musicController.currentLyricIndex >= 0)
                     lyricList.positionViewAtIndex(musicController.currentLyricIndex, ListView.Center)
             }
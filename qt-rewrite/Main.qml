@@ -61,8 +61,9 @@ ApplicationWindow {
 		if (!url) return ""
 		var s = size || 100
 		var u = url.toString()
-		if (u.indexOf("http") === 0 && u.indexOf("?param=") === -1) {
-			return u + "?param=" + s + "y" + s
+		// 网络与本地封面交给 C++ 图片提供者，在工作线程上解码并缩放到所需尺寸
+		if (u.indexOf("http") === 0 || u.indexOf("file:") === 0) {
+			return "image://cover/" + encodeURIComponent(u) + "/" + s
 		}
 		return u
 	}
@@ -1142,7 +1143,7 @@ ApplicationWindow {
 									clip: true
 									delegate: Text {
 										width: lyricView.width
-										text: model.text
+										text: model.translation ? model.text + "\n" + model.translation : model.text
 										color: musicController && index === musicController.currentLyricIndex ? "#111827" : "#9ca3af"
 										horizontalAlignment: Text.AlignHCenter
 										wrapMode: Text.Wrap
@@ -2391,10 +2392,23 @@ ApplicationWindow {
 								color: "#22c55e"
 							}
 						}
+						// 播放位置按时钟的同步点逐帧外推，C++ 不再每次位置上报都通知
+						property real livePositionMs: 0
+						function refreshPosition() {
+							livePositionMs = musicController ? musicController.playbackClock.positionAt(Date.now()) : 0
+						}
+						FrameAnimation {
+							running: appWindow.visible && musicController && musicController.playing
+							onTriggered: progressSlider.refreshPosition()
+						}
+						Connections {
+							target: musicController ? musicController.playbackClock : null
+							function onSynced() { progressSlider.refreshPosition() }
+						}
 						Binding {
 							target: progressSlider
 							property: "value"
-							value: musicController ? musicController.positionMs : 0
+							value: progressSlider.livePositionMs
 							when: !progressSlider.pressed
 						}
 					}
@@ -4,6 +4,7 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQuickStyle>
+#include <QQuickWindow>
 
 #include "core_types.h"
 #include "logger.h"
@@ -35,6 +36,8 @@ int main(int argc, char *argv[])
 	QQmlApplicationEngine engine;
 	auto *musicController = new App::MusicController(&engine);
 	engine.rootContext()->setContextProperty("musicController", musicController);
+	// 封面缩略图在工作线程上解码缩放，QML 通过 image://cover/<地址>/<尺寸> 加载
+	engine.addImageProvider(QStringLiteral("cover"), musicController->createCoverImageProvider());
 	// 当根对象创建失败时，退出应用，避免进入不一致状态
 	QObject::connect(
 		&engine,
@@ -43,6 +46,12 @@ int main(int argc, char *argv[])
 		[]() { QCoreApplication::exit(-1); },
 		Qt::QueuedConnection);
 	engine.loadFromModule("qtrewrite", "Main");
+	// 首帧显示后再预热恢复的播放队列，不与界面启动争抢资源
+	if (auto *window = qobject_cast<QQuickWindow *>(engine.rootObjects().value(0)))
+	{
+		QObject::connect(window, &QQuickWindow::frameSwapped, musicController, &App::MusicController::startWarmUp,
+			static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::SingleShotConnection));
+	}
 
 	// 进入 Qt 事件循环
 	return app.exec();
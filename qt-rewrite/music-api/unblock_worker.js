@@ -0,0 +1,88 @@
+// 常驻解灰进程：启动时只加载一次 @unblockneteasemusic/server，
+// 之后通过 stdin/stdout 的 JSON 行协议接收匹配请求，避免每首歌都冷启动 node。
+//
+// 请求（每行一个 JSON）：
+//   {"id": 1, "op": "match", "songId": "123", "platforms": ["kugou"], "song": {...}}
+//   {"id": 1, "op": "cancel"}
+// 响应（每行一个 JSON）：
+//   {"ready": true}
+//   {"id": 1, "ok": true, "data": {...}}
+//   {"id": 1, "ok": false, "error": "..."}
+
+const readline = require('readline');
+
+// 协议只占用 stdout，其余输出（包括依赖库的日志）统一改写到 stderr
+const protocolWrite = process.stdout.write.bind(process.stdout);
+const log = (...a) => process.stderr.write(a.map((x) => (typeof x === 'string' ? x : JSON.stringify(x))).join(' ') + '\n');
+console.log = log;
+console.info = log;
+console.warn = log;
+console.error = log;
+process.stdout.write = (chunk, ...rest) => process.stderr.write(chunk, ...rest);
+
+const reply = (msg) => protocolWrite(JSON.stringify(msg) + '\n');
+
+let match;
+try {
+  const mod = require('@unblockneteasemusic/server');
+  match = mod.default || mod;
+} catch (err) {
+  log('Failed to load @unblockneteasemusic/server:', (err && err.stack) || String(err));
+  process.exit(2);
+}
+
+// 进行中的请求 id；被取消的请求结果直接丢弃
+const pending = new Set();
+const cancelled = new Set();
+
+const handleMatch = (req) => {
+  const id = req.id;
+  const songId = Number.parseInt(String(req.songId), 10);
+  let platforms = req.platforms;
+  if (!Array.isArray(platforms)) platforms = platforms ? [String(platforms)] : [];
+  const song = req.song && typeof req.song === 'object' ? req.song : {};
+
+  pending.add(id);
+  Promise.resolve()
+    .then(() => match(songId, platforms, song))
+    .then((data) => {
+      pending.delete(id);
+      if (cancelled.delete(id)) return;
+      reply({ id, ok: true, data: data || {} });
+    })
+    .catch((err) => {
+      pending.delete(id);
+      if (cancelled.delete(id)) return;
+      reply({ id, ok: false, error: String((err && (err.message || err.stack)) || err) });
+    });
+};
+
+const rl = readline.createInterface({ input: process.stdin, terminal: false });
+rl.on('line', (line) => {
+  const text = line.trim();
+  if (!text) return;
+  let req;
+  try {
+    req = JSON.parse(text);
+  } catch (e) {
+    log('Bad request line:', text.slice(0, 200));
+    return;
+  }
+  if (!req || typeof req !== 'object' || req.id === undefined) return;
+  if (req.op === 'cancel') {
+    if (pending.has(req.id)) cancelled.add(req.id);
+    return;
+  }
+  if (req.op === 'match') {
+    handleMatch(req);
+    return;
+  }
+  reply({ id: req.id, ok: false, error: `Unknown op: ${req.op}` });
+});
+
+// 宿主关闭 stdin 即视为退出信号
+rl.on('close', () => process.exit(0));
+
+process.on('unhandledRejection', (err) => log('Unhandled rejection:', (err && err.stack) || String(err)));
+
+reply({ ready: true });
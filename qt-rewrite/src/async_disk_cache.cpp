@@ -0,0 +1,91 @@
+// AsyncDiskCache 实现：将 DiskCache 的调用封装为 I/O 线程上的任务
+#include "async_disk_cache.h"
+
+namespace App
+{
+
+AsyncDiskCache::AsyncDiskCache(const QString &namespaceName, qint64 maxBytes, QObject *parent)
+	: QObject(parent)
+	, cache(namespaceName, maxBytes)
+{
+	pool.setMaxThreadCount(1);
+	// 线程常驻，索引日志文件始终在同一线程上读写
+	pool.setExpiryTimeout(-1);
+}
+
+AsyncDiskCache::~AsyncDiskCache()
+{
+	pool.waitForDone();
+}
+
+QString AsyncDiskCache::filePathForKeyExt(const QString &key, const QString &ext) const
+{
+	return cache.filePathForKeyExt(key, ext);
+}
+
+QUrl AsyncDiskCache::fileUrlForKeyExt(const QString &key, const QString &ext) const
+{
+	return cache.fileUrlForKeyExt(key, ext);
+}
+
+void AsyncDiskCache::get(const QString &key, const ReadCallback &callback)
+{
+	run<QByteArray>([key](DiskCache &c) -> QByteArray {
+		QByteArray data;
+		if (!c.get(key, data))
+			return QByteArray();
+		// 空内容与未命中区分开：命中时至少返回一个非空的 QByteArray
+		return data.isNull() ? QByteArray("") : data;
+	}, [callback](QByteArray data) {
+		if (callback)
+			callback(!data.isNull(), data);
+	});
+}
+
+void AsyncDiskCache::put(const QString &key, const QByteArray &data, const DoneCallback &callback)
+{
+	putWithExt(key, data, QStringLiteral("bin"), callback);
+}
+
+void AsyncDiskCache::putWithExt(const QString &key, const QByteArray &data, const QString &ext, const DoneCallback &callback)
+{
+	if (!callback)
+	{
+		post([key, data, ext](DiskCache &c) {
+			c.putWithExt(key, data, ext);
+		});
+		return;
+	}
+	run<bool>([key, data, ext](DiskCache &c) -> bool {
+		return c.putWithExt(key, data, ext);
+	}, callback);
+}
+
+void AsyncDiskCache::resolveExisting(const QString &key, const QStringList &exts, const PathCallback &callback)
+{
+	run<QString>([key, exts](DiskCache &c) -> QString {
+		const QString path = c.resolveExistingFilePathForKey(key, exts);
+		if (!path.isEmpty())
+			c.touch(path);
+		return path;
+	}, [callback](QString path) {
+		if (callback)
+			callback(path);
+	});
+}
+
+void AsyncDiskCache::touch(const QString &filePath)
+{
+	post([filePath](DiskCache &c) {
+		c.touch(filePath);
+	});
+}
+
+void AsyncDiskCache::post(const std::function<void(DiskCache &)> &task)
+{
+	pool.start([this, task]() {
+		task(cache);
+	});
+}
+
+}
@@ -0,0 +1,66 @@
+// AsyncDiskCache：DiskCache 的异步前端，磁盘操作在专用 I/O 线程上串行执行，回调回到调用方所在线程
+#pragma once
+
+#include <QByteArray>
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <functional>
+
+#include "disk_cache.h"
+
+namespace App
+{
+
+class AsyncDiskCache : public QObject
+{
+	Q_OBJECT
+
+public:
+	using ReadCallback = std::function<void(bool ok, const QByteArray &data)>;
+	using PathCallback = std::function<void(const QString &filePath)>;
+	using DoneCallback = std::function<void(bool ok)>;
+
+	AsyncDiskCache(const QString &namespaceName, qint64 maxBytes, QObject *parent = nullptr);
+	// 等待已提交的磁盘操作全部完成
+	~AsyncDiskCache() override;
+
+	// 纯路径计算，不访问磁盘
+	QString filePathForKeyExt(const QString &key, const QString &ext) const;
+	QUrl fileUrlForKeyExt(const QString &key, const QString &ext) const;
+
+	void get(const QString &key, const ReadCallback &callback);
+	void put(const QString &key, const QByteArray &data, const DoneCallback &callback = DoneCallback());
+	void putWithExt(const QString &key, const QByteArray &data, const QString &ext, const DoneCallback &callback = DoneCallback());
+	// 查找已存在的文件并刷新使用时间，未命中时回调空路径
+	void resolveExisting(const QString &key, const QStringList &exts, const PathCallback &callback);
+	void touch(const QString &filePath);
+
+	// 在 I/O 线程上执行任意缓存操作，不关心结果
+	void post(const std::function<void(DiskCache &)> &task);
+
+	// 在 I/O 线程上执行任意缓存操作，结果通过 done 回到调用方线程；本对象销毁后不再回调
+	template <typename R>
+	void run(const std::function<R(DiskCache &)> &task, const std::function<void(R)> &done)
+	{
+		pool.start([this, task, done]() {
+			R result = task(cache);
+			if (!done)
+				return;
+			QMetaObject::invokeMethod(this, [done, result]() {
+				done(result);
+			}, Qt::QueuedConnection);
+		});
+	}
+
+private:
+	DiskCache cache;
+	// 单线程池：保证同一命名空间的读写按提交顺序执行
+	QThreadPool pool;
+};
+
+}
@@ -0,0 +1,552 @@
+// AudioCache 实现：后台下载写入 .part 部分文件，校验完整后转为正式缓存文件；播放中的下载同时交给音频流
+#include "audio_cache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QPair>
+#include <QPointer>
+#include <QTimer>
+
+#include <cstring>
+
+#include "logger.h"
+
+namespace
+{
+
+// 响应头名称大小写不敏感（HTTP/2 下均为小写）
+QByteArray headerValue(const QMap<QByteArray, QByteArray> &headers, const QByteArray &name)
+{
+	for (auto it = headers.cbegin(); it != headers.cend(); ++it)
+	{
+		if (it.key().compare(name, Qt::CaseInsensitive) == 0)
+			return it.value();
+	}
+	return QByteArray();
+}
+
+// 解析 Content-Range：bytes start-end/total 或 bytes */total，未知部分返回 -1
+void parseContentRange(const QByteArray &value, qint64 &start, qint64 &total)
+{
+	start = -1;
+	total = -1;
+	QByteArray v = value.trimmed();
+	if (!v.startsWith("bytes"))
+		return;
+	v = v.mid(5).trimmed();
+	const int slash = v.indexOf('/');
+	if (slash < 0)
+		return;
+	bool ok = false;
+	const qint64 t = v.mid(slash + 1).trimmed().toLongLong(&ok);
+	if (ok)
+		total = t;
+	const QByteArray range = v.left(slash).trimmed();
+	const int dash = range.indexOf('-');
+	if (dash > 0)
+	{
+		const qint64 s = range.left(dash).toLongLong(&ok);
+		if (ok)
+			start = s;
+	}
+}
+
+}
+
+namespace App
+{
+
+AudioStream::AudioStream(QObject *parent)
+	: QIODevice(parent)
+{
+}
+
+AudioStream::~AudioStream()
+{
+	abort();
+}
+
+// 支持随机访问：播放器可以跳转，跳到尚未到达的位置时等待下载
+bool AudioStream::isSequential() const
+{
+	return false;
+}
+
+qint64 AudioStream::size() const
+{
+	QMutexLocker locker(&mutex);
+	return buffer.size();
+}
+
+qint64 AudioStream::bytesAvailable() const
+{
+	QMutexLocker locker(&mutex);
+	// 以无缓冲方式打开，基类没有额外缓冲的数据
+	return qMax<qint64>(0, buffer.size() - pos());
+}
+
+bool AudioStream::atEnd() const
+{
+	QMutexLocker locker(&mutex);
+	return aborted || (finished && !failed && headReady && pos() >= buffer.size());
+}
+
+void AudioStream::abort()
+{
+	QMutexLocker locker(&mutex);
+	aborted = true;
+	dataArrived.wakeAll();
+}
+
+qint64 AudioStream::readData(char *data, qint64 maxSize)
+{
+	QMutexLocker locker(&mutex);
+	const qint64 offset = pos();
+	while (!aborted && !failed && (!headReady || (offset >= buffer.size() && !finished)))
+		dataArrived.wait(&mutex);
+	if (aborted || !headReady)
+		return -1;
+	const qint64 n = qMin<qint64>(maxSize, buffer.size() - offset);
+	if (n > 0)
+	{
+		std::memcpy(data, buffer.constData() + offset, static_cast<size_t>(n));
+		return n;
+	}
+	// 下载中断时已到达的数据读完即报错，由播放器的错误处理重新解析地址
+	return failed ? -1 : 0;
+}
+
+qint64 AudioStream::writeData(const char *data, qint64 maxSize)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxSize);
+	return -1;
+}
+
+void AudioStream::setHead(const QByteArray &head)
+{
+	{
+		QMutexLocker locker(&mutex);
+		buffer = head + pendingTail;
+		pendingTail.clear();
+		headReady = true;
+		dataArrived.wakeAll();
+	}
+	emit readyRead();
+}
+
+void AudioStream::append(const QByteArray &chunk)
+{
+	{
+		QMutexLocker locker(&mutex);
+		if (headReady)
+			buffer.append(chunk);
+		else
+			pendingTail.append(chunk);
+		dataArrived.wakeAll();
+	}
+	emit readyRead();
+}
+
+void AudioStream::finish(bool ok)
+{
+	QMutexLocker locker(&mutex);
+	if (finished)
+		return;
+	finished = true;
+	failed = !ok;
+	dataArrived.wakeAll();
+}
+
+AudioCache::AudioCache(HttpClient *client, qint64 maxBytes, QObject *parent)
+	: QObject(parent)
+	, client(client)
+	, cache(QStringLiteral("audio"), maxBytes)
+{
+}
+
+AudioCache::~AudioCache()
+{
+	const QList<QSharedPointer<Download>> pending = downloads.values();
+	downloads.clear();
+	for (const QSharedPointer<Download> &d : pending)
+	{
+		if (d->token)
+			d->token->cancel();
+		if (d->stream)
+			d->stream->finish(false);
+		releaseFile(d);
+	}
+}
+
+QString AudioCache::cacheKey(const QString &providerId, const QString &songId, const QString &quality)
+{
+	return providerId + QStringLiteral(":") + songId + QStringLiteral(":") + quality;
+}
+
+QStringList AudioCache::knownExts()
+{
+	return {QStringLiteral("mp3"), QStringLiteral("flac"), QStringLiteral("m4a"), QStringLiteral("aac"), QStringLiteral("ogg"), QStringLiteral("wav"), QStringLiteral("bin")};
+}
+
+QString AudioCache::partPath(DiskCache &c, const QString &key)
+{
+	return c.filePathForKeyExt(key, QStringLiteral("part"));
+}
+
+void AudioCache::lookup(const QString &key, const std::function<void(const QUrl &fileUrl)> &callback)
+{
+	cache.resolveExisting(key, knownExts(), [callback](const QString &path) {
+		if (callback)
+			callback(path.isEmpty() ? QUrl() : QUrl::fromLocalFile(path));
+	});
+}
+
+bool AudioCache::isDownloading(const QString &key) const
+{
+	return downloads.contains(key);
+}
+
+void AudioCache::fetch(const QString &key, const QUrl &remoteUrl, RequestPriority priority, qint64 maxBytes)
+{
+	if (key.isEmpty() || !remoteUrl.isValid() || remoteUrl.isLocalFile())
+		return;
+	auto running = downloads.constFind(key);
+	// 已取消、只待收尾的下载（如达到预取上限）不再接管，重新续传；I/O 线程上的串行顺序保证旧文件先关闭
+	if (running != downloads.constEnd() && running.value()->token && running.value()->token->isCancelled())
+	{
+		downloads.erase(running);
+		running = downloads.constEnd();
+	}
+	if (running != downloads.constEnd())
+	{
+		// 已在下载：按需提升优先级，并放宽下载上限（预取转为正式播放时继续下载完整文件）
+		const QSharedPointer<Download> &download = running.value();
+		if (static_cast<int>(priority) > static_cast<int>(download->priority))
+			download->priority = priority;
+		if (download->token && static_cast<int>(priority) > static_cast<int>(download->token->priority()))
+			download->token->setPriority(priority);
+		if (download->maxBytes > 0 && (maxBytes <= 0 || maxBytes > download->maxBytes))
+		{
+			download->maxBytes = maxBytes > 0 ? maxBytes : -1;
+			download->stopScheduled = false;
+		}
+		return;
+	}
+
+	// 先登记下载，检查已有缓存与打开部分文件在 I/O 线程上完成
+	QSharedPointer<Download> download = QSharedPointer<Download>::create();
+	download->key = key;
+	download->priority = priority;
+	download->maxBytes = maxBytes > 0 ? maxBytes : -1;
+	downloads.insert(key, download);
+
+	const QStringList exts = knownExts();
+	cache.run<qint64>([download, exts](DiskCache &c) -> qint64 {
+		if (!c.resolveExistingFilePathForKey(download->key, exts).isEmpty())
+			return -1;
+		QFile *file = new QFile(partPath(c, download->key));
+		if (!file->open(QIODevice::WriteOnly | QIODevice::Append))
+		{
+			Logger::warning(QStringLiteral("Audio cache open failed: %1").arg(file->fileName()));
+			delete file;
+			return -1;
+		}
+		download->file = file;
+		return file->size();
+	}, [this, download, remoteUrl](qint64 offset) {
+		// 打开期间已被取消，或已完整缓存
+		if (downloads.value(download->key) != download || offset < 0)
+		{
+			if (downloads.value(download->key) == download)
+				downloads.remove(download->key);
+			if (download->stream)
+				download->stream->finish(false);
+			releaseFile(download);
+			return;
+		}
+		if (download->maxBytes > 0 && offset >= download->maxBytes)
+		{
+			downloads.remove(download->key);
+			releaseFile(download);
+			return;
+		}
+		download->offset = offset;
+		startRequest(download, remoteUrl);
+	});
+}
+
+AudioStream *AudioCache::openStream(const QString &key, const QUrl &remoteUrl)
+{
+	fetch(key, remoteUrl, RequestPriority::Playback);
+	const QSharedPointer<Download> download = downloads.value(key);
+	if (!download)
+		return nullptr;
+	AudioStream *stream = new AudioStream;
+	stream->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+	// 一次下载只供一个流读取，旧的流（重新打开同一首歌）随之结束
+	if (download->stream)
+		download->stream->finish(false);
+	download->stream = stream;
+
+	// I/O 线程按提交顺序执行：此前提交的写入都已在部分文件中，此后到达的数据由 writeChunk 直接追加到流上
+	QPointer<AudioStream> target(stream);
+	cache.run<QPair<bool, QByteArray>>([download](DiskCache &c) -> QPair<bool, QByteArray> {
+		if (download->ioFailed)
+			return qMakePair(false, QByteArray());
+		if (download->file)
+			download->file->flush();
+		QFile part(partPath(c, download->key));
+		if (!part.open(QIODevice::ReadOnly))
+			return qMakePair(false, QByteArray());
+		return qMakePair(true, part.readAll());
+	}, [target](QPair<bool, QByteArray> head) {
+		if (!target)
+			return;
+		if (head.first)
+			target->setHead(head.second);
+		else
+			target->finish(false);
+	});
+	return stream;
+}
+
+void AudioCache::cancel(const QString &key)
+{
+	QSharedPointer<Download> download = downloads.value(key);
+	if (!download)
+		return;
+	// 立即撤销登记：尚未发起请求的不再发起；随后对同一 key 的 fetch 重新开始，I/O 线程上的串行顺序保证旧文件先关闭
+	downloads.remove(key);
+	if (download->token)
+		download->token->cancel();
+}
+
+void AudioCache::cancelAllExcept(const QString &key)
+{
+	const QStringList keys = downloads.keys();
+	for (const QString &k : keys)
+	{
+		if (k != key)
+			cancel(k);
+	}
+}
+
+void AudioCache::startRequest(const QSharedPointer<Download> &download, const QUrl &remoteUrl)
+{
+	HttpRequestOptions opts;
+	opts.url = remoteUrl;
+	opts.priority = download->priority;
+	opts.headers.insert("Accept", "*/*");
+	// 按整首歌的下载耗时设置上限，而不是单次接口请求的超时
+	opts.timeoutMs = 10 * 60 * 1000;
+	if (download->offset > 0)
+	{
+		opts.headers.insert("Range", QByteArray("bytes=") + QByteArray::number(download->offset) + "-");
+		Logger::debug(QStringLiteral("Audio cache resume %1 from %2 bytes").arg(download->key).arg(download->offset));
+	}
+
+	QPointer<AudioCache> self(this);
+	download->token = client->sendStreaming(opts, [self, download](const QByteArray &chunk) {
+		if (!self)
+			return;
+		self->writeChunk(download, chunk);
+	}, [self, download](Result<HttpResponse> result) {
+		if (!self)
+			return;
+		self->finishDownload(download, result);
+	});
+}
+
+void AudioCache::writeChunk(const QSharedPointer<Download> &download, const QByteArray &chunk)
+{
+	// 同一份数据同时交给正在播放的音频流
+	if (download->stream)
+		download->stream->append(chunk);
+	// 写入按提交顺序在 I/O 线程上串行执行，GUI 线程只负责计数与取消
+	if (!download->writeFailed)
+	{
+		cache.run<bool>([download, chunk](DiskCache &) -> bool {
+			if (download->ioFailed || !download->file)
+				return true;
+			if (download->file->write(chunk) != chunk.size())
+			{
+				download->ioFailed = true;
+				Logger::warning(QStringLiteral("Audio cache write failed: %1").arg(download->file->errorString()));
+				return false;
+			}
+			return true;
+		}, [download](bool ok) {
+			if (ok || download->writeFailed)
+				return;
+			// 磁盘写入失败：放弃缓存，完成时丢弃部分文件；仍在播放时继续下载供播放使用
+			download->writeFailed = true;
+			if (download->token && !download->stream)
+				download->token->cancel();
+		});
+	}
+	download->received += chunk.size();
+	// 达到预取上限后停止下载，保留部分文件；取消生效前到达的数据照常写入，保证文件连续
+	if (download->maxBytes > 0 && !download->stopScheduled && download->offset + download->received >= download->maxBytes)
+	{
+		download->stopScheduled = true;
+		QTimer::singleShot(0, this, [download]() {
+			if (download->stopScheduled && download->maxBytes > 0 && download->token)
+				download->token->cancel();
+		});
+	}
+}
+
+void AudioCache::releaseFile(const QSharedPointer<Download> &download)
+{
+	cache.post([download](DiskCache &) {
+		if (!download->file)
+			return;
+		download->file->close();
+		delete download->file;
+		download->file = nullptr;
+	});
+}
+
+void AudioCache::finishDownload(const QSharedPointer<Download> &download, const Result<HttpResponse> &result)
+{
+	if (downloads.value(download->key) == download)
+		downloads.remove(download->key);
+	if (download->stream)
+	{
+		// 416 表示续传起点已是文件末尾，部分文件即完整内容
+		const int status = result.ok ? result.value.statusCode : 0;
+		download->stream->finish(status == 200 || status == 206 || status == 416);
+	}
+	const QString key = download->key;
+	cache.run<QString>([download, result](DiskCache &c) -> QString {
+		return finishOnDisk(c, *download, result);
+	}, [this, key](QString finalPath) {
+		if (!finalPath.isEmpty())
+			emit completed(key, QUrl::fromLocalFile(finalPath));
+	});
+}
+
+QString AudioCache::finishOnDisk(DiskCache &c, Download &download, const Result<HttpResponse> &result)
+{
+	if (!download.file)
+		return QString();
+	download.file->close();
+	delete download.file;
+	download.file = nullptr;
+
+	const QString &key = download.key;
+	const QString part = partPath(c, key);
+	// 部分文件同样计入音频缓存容量，长期未续传的会随 LRU 淘汰
+	c.recordFile(part);
+	if (download.ioFailed)
+	{
+		discardPartial(c, key);
+		return QString();
+	}
+	const qint64 size = QFileInfo(part).size();
+	if (!result.ok)
+	{
+		// 取消或网络中断：保留部分文件，下次续传
+		if (result.error.code != -2)
+			Logger::warning(QStringLiteral("Audio cache download interrupted: %1 (%2 bytes kept)").arg(result.error.message).arg(size));
+		return QString();
+	}
+
+	const HttpResponse &response = result.value;
+	qint64 rangeStart = -1;
+	qint64 total = -1;
+	parseContentRange(headerValue(response.headers, "Content-Range"), rangeStart, total);
+
+	// 续传起点已等于文件总长：部分文件其实已完整
+	if (response.statusCode == 416)
+	{
+		if (total > 0 && size == total)
+			return promote(c, key);
+		discardPartial(c, key);
+		return QString();
+	}
+	if (response.statusCode != 200 && response.statusCode != 206)
+	{
+		// 地址过期等错误：部分文件仍然有效，换新地址后可继续续传
+		Logger::warning(QStringLiteral("Audio cache download failed: status %1").arg(response.statusCode));
+		return QString();
+	}
+	// 续传时服务端忽略了 Range 返回整个文件，已追加的数据无法使用
+	if (download.offset > 0 && (response.statusCode != 206 || rangeStart != download.offset))
+	{
+		Logger::warning(QStringLiteral("Audio cache resume rejected by server (status %1), discarding partial file").arg(response.statusCode));
+		discardPartial(c, key);
+		return QString();
+	}
+	if (response.statusCode == 200)
+	{
+		bool ok = false;
+		const qint64 length = headerValue(response.headers, "Content-Length").trimmed().toLongLong(&ok);
+		total = ok ? length : -1;
+	}
+	if (total > 0 && size != total)
+	{
+		// 连接提前关闭时保留部分文件；超出总长说明数据已混入其他文件
+		if (size > total)
+			discardPartial(c, key);
+		else
+			Logger::warning(QStringLiteral("Audio cache incomplete: %1 of %2 bytes").arg(size).arg(total));
+		return QString();
+	}
+	return promote(c, key);
+}
+
+QString AudioCache::promote(DiskCache &c, const QString &key)
+{
+	const QString part = partPath(c, key);
+	if (QFileInfo(part).size() <= 0)
+	{
+		c.removeFile(part);
+		return QString();
+	}
+	const QString finalPath = c.filePathForKeyExt(key, sniffExt(part));
+	c.removeFile(finalPath);
+	if (!QFile::rename(part, finalPath))
+	{
+		Logger::warning(QStringLiteral("Audio cache rename failed: %1").arg(finalPath));
+		return QString();
+	}
+	c.removeFile(part);
+	c.recordFile(finalPath);
+	Logger::info(QStringLiteral("Audio cached: %1 (%2 bytes)").arg(key).arg(QFileInfo(finalPath).size()));
+	return finalPath;
+}
+
+void AudioCache::discardPartial(DiskCache &c, const QString &key)
+{
+	c.removeFile(partPath(c, key));
+}
+
+// 按文件头识别容器格式，便于解码后端按扩展名选择 demuxer
+QString AudioCache::sniffExt(const QString &filePath)
+{
+	QFile f(filePath);
+	if (!f.open(QIODevice::ReadOnly))
+		return QStringLiteral("bin");
+	const QByteArray head = f.read(12);
+	f.close();
+	if (head.startsWith("fLaC"))
+		return QStringLiteral("flac");
+	if (head.startsWith("OggS"))
+		return QStringLiteral("ogg");
+	if (head.startsWith("RIFF") && head.mid(8, 4) == "WAVE")
+		return QStringLiteral("wav");
+	if (head.size() >= 8 && head.mid(4, 4) == "ftyp")
+		return QStringLiteral("m4a");
+	if (head.startsWith("ID3"))
+		return QStringLiteral("mp3");
+	if (head.size() >= 2 && static_cast<uchar>(head.at(0)) == 0xFF && (static_cast<uchar>(head.at(1)) & 0xF0) == 0xF0 && (static_cast<uchar>(head.at(1)) & 0x06) == 0)
+		return QStringLiteral("aac");
+	if (head.size() >= 2 && static_cast<uchar>(head.at(0)) == 0xFF && (static_cast<uchar>(head.at(1)) & 0xE0) == 0xE0)
+		return QStringLiteral("mp3");
+	return QStringLiteral("bin");
+}
+
+}
@@ -0,0 +1,136 @@
+// AudioCache：音频文件缓存，播放远程地址的同时在后台写入本地，完整后再次播放直接使用本地文件
+#pragma once
+
+#include <QHash>
+#include <QIODevice>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QUrl>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "async_disk_cache.h"
+#include "http_client.h"
+
+class QFile;
+
+namespace App
+{
+
+// 播放用的音频流：开头取自已写入的部分文件，其后是同一次下载陆续到达的数据，播放与缓存只下载一次。
+// 播放器在自己的线程上读取，数据未到达时阻塞等待；数据保存在内存中，随流一起释放
+class AudioStream : public QIODevice
+{
+	Q_OBJECT
+
+public:
+	explicit AudioStream(QObject *parent = nullptr);
+	~AudioStream() override;
+
+	bool isSequential() const override;
+	// 下载完成前总长未知，返回已到达的字节数
+	qint64 size() const override;
+	qint64 bytesAvailable() const override;
+	bool atEnd() const override;
+	// 中止读取，阻塞中的读取立即返回错误；切换音源前调用，避免播放器等待读取线程
+	void abort();
+
+protected:
+	qint64 readData(char *data, qint64 maxSize) override;
+	qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+	friend class AudioCache;
+	void setHead(const QByteArray &head);
+	void append(const QByteArray &chunk);
+	void finish(bool ok);
+
+	mutable QMutex mutex;
+	QWaitCondition dataArrived;
+	// 已可读取的数据：部分文件的内容加上之后到达的数据
+	QByteArray buffer;
+	// 部分文件读取完成前到达的数据，读取完成后接在其后
+	QByteArray pendingTail;
+	bool headReady = false;
+	bool finished = false;
+	bool failed = false;
+	bool aborted = false;
+};
+
+class AudioCache : public QObject
+{
+	Q_OBJECT
+
+public:
+	// maxBytes 为音频缓存的独立容量上限，与图片、歌词缓存互不影响
+	AudioCache(HttpClient *client, qint64 maxBytes, QObject *parent = nullptr);
+	~AudioCache() override;
+
+	// 缓存 key：来源 + 歌曲 id + 音质，同一首歌不同音质分别缓存
+	static QString cacheKey(const QString &providerId, const QString &songId, const QString &quality);
+
+	// 已完整缓存时回调本地文件地址（并刷新使用时间），否则回调空地址
+	void lookup(const QString &key, const std::function<void(const QUrl &fileUrl)> &callback);
+	bool isDownloading(const QString &key) const;
+
+	// 开始下载或从部分文件断点续传；已完整缓存时直接返回
+	// maxBytes > 0 时只下载文件开头的 maxBytes 字节（预取），正在下载时再次调用可提升优先级或解除该上限
+	void fetch(const QString &key, const QUrl &remoteUrl, RequestPriority priority = RequestPriority::Prefetch, qint64 maxBytes = -1);
+	// 打开边下边播的音频流：与缓存共用同一次下载（必要时发起或接管预取，解除下载上限并提升为播放优先级），
+	// 已下载的开头直接从部分文件读取。无法下载时返回 nullptr；返回的流由调用方释放
+	AudioStream *openStream(const QString &key, const QUrl &remoteUrl);
+	// 中止下载，保留部分文件供下次续传
+	void cancel(const QString &key);
+	// 中止除 key 以外的所有下载
+	void cancelAllExcept(const QString &key);
+
+signals:
+	void completed(const QString &key, const QUrl &fileUrl);
+
+private:
+	struct Download
+	{
+		QString key;
+		QSharedPointer<RequestToken> token;
+		// 打开部分文件期间记录的请求优先级，请求发出后以 token 为准
+		RequestPriority priority = RequestPriority::Prefetch;
+		// 本次请求的起始偏移（续传时为部分文件大小）
+		qint64 offset = 0;
+		qint64 received = 0;
+		// 下载上限（含已有部分），-1 表示下载完整文件
+		qint64 maxBytes = -1;
+		bool stopScheduled = false;
+		bool writeFailed = false;
+		// 正在播放这次下载的音频流
+		QPointer<AudioStream> stream;
+		// 以下字段只在 I/O 线程上访问
+		QFile *file = nullptr;
+		bool ioFailed = false;
+	};
+
+	HttpClient *client = nullptr;
+	AsyncDiskCache cache;
+	QHash<QString, QSharedPointer<Download>> downloads;
+
+	void startRequest(const QSharedPointer<Download> &download, const QUrl &remoteUrl);
+	void writeChunk(const QSharedPointer<Download> &download, const QByteArray &chunk);
+	void finishDownload(const QSharedPointer<Download> &download, const Result<HttpResponse> &result);
+	// 关闭部分文件（I/O 线程上执行）
+	void releaseFile(const QSharedPointer<Download> &download);
+
+	// 以下在 I/O 线程上执行
+	static QString partPath(DiskCache &c, const QString &key);
+	// 校验下载结果，完整时返回正式缓存文件路径
+	static QString finishOnDisk(DiskCache &c, Download &download, const Result<HttpResponse> &result);
+	// 校验并将部分文件转为正式缓存文件
+	static QString promote(DiskCache &c, const QString &key);
+	static void discardPartial(DiskCache &c, const QString &key);
+	static QString sniffExt(const QString &filePath);
+	static QStringList knownExts();
+};
+
+}
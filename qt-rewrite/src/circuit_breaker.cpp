@@ -0,0 +1,164 @@
+// CircuitBreaker 实现：滑动窗口统计与状态切换
+#include "circuit_breaker.h"
+
+#include <QDateTime>
+
+namespace App
+{
+
+CircuitBreaker::CircuitBreaker(const CircuitBreakerConfig &config)
+	: cfg(config)
+	, currentOpenMs(config.openMs)
+{
+}
+
+bool CircuitBreaker::isCallPermitted() const
+{
+	switch (current)
+	{
+	case State::Closed:
+		return true;
+	case State::Open:
+		return QDateTime::currentMSecsSinceEpoch() >= openUntil;
+	case State::HalfOpen:
+		return !probeInFlight || QDateTime::currentMSecsSinceEpoch() - probeStartedAt >= cfg.openMs;
+	}
+	return true;
+}
+
+void CircuitBreaker::onCallStarted()
+{
+	if (current == State::Open && QDateTime::currentMSecsSinceEpoch() >= openUntil)
+		current = State::HalfOpen;
+	if (current == State::HalfOpen)
+	{
+		probeInFlight = true;
+		probeStartedAt = QDateTime::currentMSecsSinceEpoch();
+	}
+}
+
+void CircuitBreaker::recordSuccess(qint64 latencyMs)
+{
+	Outcome outcome;
+	outcome.latencyMs = latencyMs;
+	outcome.slow = latencyMs >= cfg.slowCallMs;
+	if (current == State::HalfOpen)
+	{
+		// 探测成功即恢复；探测虽成功但仍然很慢时保持打开
+		probeInFlight = false;
+		if (outcome.slow)
+		{
+			open();
+			return;
+		}
+		close();
+	}
+	record(outcome);
+}
+
+void CircuitBreaker::recordFailure()
+{
+	if (current == State::HalfOpen)
+	{
+		probeInFlight = false;
+		// 探测失败，打开时长翻倍
+		currentOpenMs = qMin(currentOpenMs * 2, cfg.maxOpenMs);
+		open();
+		return;
+	}
+	Outcome outcome;
+	outcome.failed = true;
+	record(outcome);
+}
+
+void CircuitBreaker::recordIgnored()
+{
+	if (current == State::HalfOpen)
+		probeInFlight = false;
+}
+
+CircuitBreaker::State CircuitBreaker::state() const
+{
+	return current;
+}
+
+CircuitBreakerSnapshot CircuitBreaker::snapshot() const
+{
+	CircuitBreakerSnapshot s;
+	switch (current)
+	{
+	case State::Closed:
+		s.state = QStringLiteral("closed");
+		break;
+	case State::Open:
+		s.state = QStringLiteral("open");
+		break;
+	case State::HalfOpen:
+		s.state = QStringLiteral("half-open");
+		break;
+	}
+	s.calls = window.size();
+	s.failureRate = rate(&Outcome::failed);
+	s.slowCallRate = rate(&Outcome::slow);
+	qint64 latencySum = 0;
+	int latencyCount = 0;
+	for (const Outcome &o : window)
+	{
+		if (o.failed)
+			continue;
+		latencySum += o.latencyMs;
+		++latencyCount;
+	}
+	s.averageLatencyMs = latencyCount > 0 ? static_cast<double>(latencySum) / latencyCount : 0.0;
+	if (current == State::Open)
+		s.openRemainingMs = qMax<qint64>(0, openUntil - QDateTime::currentMSecsSinceEpoch());
+	if (current == State::Closed)
+		s.score = qMax(0.0, 1.0 - qMax(s.failureRate, s.slowCallRate * 0.5));
+	else
+		s.score = 0.0;
+	return s;
+}
+
+void CircuitBreaker::record(const Outcome &outcome)
+{
+	if (window.size() < cfg.windowSize)
+		window.append(outcome);
+	else
+		window[nextSlot] = outcome;
+	nextSlot = (nextSlot + 1) % cfg.windowSize;
+
+	if (current != State::Closed || window.size() < cfg.minimumCalls)
+		return;
+	if (rate(&Outcome::failed) >= cfg.failureRateThreshold || rate(&Outcome::slow) >= cfg.slowCallRateThreshold)
+		open();
+}
+
+void CircuitBreaker::open()
+{
+	current = State::Open;
+	openUntil = QDateTime::currentMSecsSinceEpoch() + currentOpenMs;
+}
+
+// 恢复后清空窗口，避免打开前的旧失败再次触发熔断
+void CircuitBreaker::close()
+{
+	current = State::Closed;
+	currentOpenMs = cfg.openMs;
+	window.clear();
+	nextSlot = 0;
+}
+
+double CircuitBreaker::rate(bool Outcome::*field) const
+{
+	if (window.isEmpty())
+		return 0.0;
+	int hits = 0;
+	for (const Outcome &o : window)
+	{
+		if (o.*field)
+			++hits;
+	}
+	return static_cast<double>(hits) / window.size();
+}
+
+}
@@ -0,0 +1,90 @@
+// 熔断器：按最近调用的失败率与慢调用比例在 关闭 / 打开 / 半开 之间切换
+#pragma once
+
+#include <QList>
+#include <QString>
+
+namespace App
+{
+
+// 熔断阈值配置
+struct CircuitBreakerConfig
+{
+	// 滑动窗口大小（最近 N 次调用）
+	int windowSize = 20;
+	// 窗口内样本少于该值时不做判断
+	int minimumCalls = 5;
+	// 失败率达到该比例时打开
+	double failureRateThreshold = 0.5;
+	// 超过该耗时的成功调用视为慢调用
+	int slowCallMs = 8000;
+	// 慢调用比例达到该比例时打开
+	double slowCallRateThreshold = 0.8;
+	// 首次打开的时长，探测失败后翻倍，最长 maxOpenMs
+	int openMs = 15000;
+	int maxOpenMs = 5 * 60 * 1000;
+};
+
+// 熔断器状态快照，供诊断展示
+struct CircuitBreakerSnapshot
+{
+	QString state;
+	int calls = 0;
+	double failureRate = 0.0;
+	double slowCallRate = 0.0;
+	double averageLatencyMs = 0.0;
+	qint64 openRemainingMs = 0;
+	// 健康分：1 表示完全健康，0 表示已熔断
+	double score = 1.0;
+};
+
+class CircuitBreaker
+{
+public:
+	enum class State
+	{
+		Closed,
+		Open,
+		HalfOpen
+	};
+
+	explicit CircuitBreaker(const CircuitBreakerConfig &config = CircuitBreakerConfig());
+
+	// 当前是否允许发起调用（不改变状态），用于候选排序
+	bool isCallPermitted() const;
+	// 实际发起调用前调用：打开期已过时转入半开，并占用唯一的探测名额
+	void onCallStarted();
+	// 记录调用结果；半开状态下成功则关闭，失败则重新打开
+	void recordSuccess(qint64 latencyMs);
+	void recordFailure();
+	// 调用被取消，不计入统计，仅释放探测名额
+	void recordIgnored();
+
+	State state() const;
+	CircuitBreakerSnapshot snapshot() const;
+
+private:
+	struct Outcome
+	{
+		bool failed = false;
+		bool slow = false;
+		qint64 latencyMs = 0;
+	};
+
+	CircuitBreakerConfig cfg;
+	State current = State::Closed;
+	QList<Outcome> window;
+	int nextSlot = 0;
+	qint64 openUntil = 0;
+	int currentOpenMs = 0;
+	bool probeInFlight = false;
+	// 探测请求的发起时间：探测结果迟迟未回时允许再次探测，避免永久卡在半开
+	qint64 probeStartedAt = 0;
+
+	void record(const Outcome &outcome);
+	void open();
+	void close();
+	double rate(bool Outcome::*field) const;
+};
+
+}
@@ -29,19 +29,37 @@ struct PlayUrl
 	QUrl url;
 	int bitrate = 0;
 	qint64 size = 0;
+	// 地址过期时间（毫秒时间戳），0 表示来源未提供
+	qint64 expiresAtMs = 0;
+	// 取得地址的策略（netease / gdstudio / unblock），缺少过期信息时据此选择默认有效期
+	QString strategy;
 };
 
-// 单行歌词（时间戳 + 文本）
+// 逐字时间（yrc）：起始时间相对所在行的时间戳，length 为该字在行文本中的 UTF-16 长度
+struct LyricWord
+{
+	qint32 offsetMs = 0;
+	qint32 durationMs = 0;
+	qint32 length = 0;
+};
+
+// 单行歌词（时间戳 + 文本）；逐字时间存放在 Lyric::words 的 [wordBegin, wordBegin + wordCount) 区间
 struct LyricLine
 {
 	qint64 timeMs = 0;
 	QString text;
+	qint32 wordBegin = 0;
+	qint32 wordCount = 0;
+	// 翻译与音译（罗马音），没有时为空
+	QString translation;
+	QString romanization;
 };
 
-// 完整歌词，由多行组成
+// 完整歌词，由多行组成；所有行的逐字时间共用一个数组
 struct Lyric
 {
 	QList<LyricLine> lines;
+	QList<LyricWord> words;
 };
 
 // 歌曲基础信息
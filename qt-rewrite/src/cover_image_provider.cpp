@@ -0,0 +1,275 @@
+// CoverImageProvider 实现：缩略图命中时只解码小图，未命中时由本地母版或下载的图片缩放并写回缓存
+#include "cover_image_provider.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQuickTextureFactory>
+#include <QThread>
+
+#include <atomic>
+
+#include "cover_url.h"
+#include "logger.h"
+
+namespace App
+{
+
+// 一次图片请求的共享状态：响应对象与加载流程各持一份，完成通知只发出一次
+struct CoverImageProvider::Job
+{
+	QUrl url;
+	int size = 0;
+	// 只在 GUI 线程上访问
+	QSharedPointer<RequestToken> token;
+	std::function<void(const QImage &image, const QString &error)> done;
+	std::atomic_bool finished{false};
+
+	bool isFinished() const
+	{
+		return finished.load();
+	}
+
+	// 首次调用时交付结果；之后（包括响应已被取消）直接忽略
+	void finish(const QImage &image, const QString &error = QString())
+	{
+		if (finished.exchange(true))
+			return;
+		done(image, error);
+	}
+};
+
+namespace
+{
+
+class CoverImageResponse : public QQuickImageResponse
+{
+public:
+	explicit CoverImageResponse(const QSharedPointer<CoverImageProvider::Job> &job)
+		: job(job)
+	{
+		// 结果可能在任意线程交付，finished 信号允许跨线程发出
+		job->done = [this](const QImage &result, const QString &error) {
+			{
+				QMutexLocker locker(&mutex);
+				image = result;
+				errorText = error;
+			}
+			emit finished();
+		};
+	}
+
+	QQuickTextureFactory *textureFactory() const override
+	{
+		QMutexLocker locker(&mutex);
+		return QQuickTextureFactory::textureFactoryForImage(image);
+	}
+
+	QString errorString() const override
+	{
+		QMutexLocker locker(&mutex);
+		return errorText;
+	}
+
+	// 取消后立即结束响应；下载令牌只能在 GUI 线程上取消
+	void cancel() override
+	{
+		QSharedPointer<CoverImageProvider::Job> j = job;
+		j->finish(QImage(), QStringLiteral("Cancelled"));
+		if (QCoreApplication *app = QCoreApplication::instance())
+		{
+			QMetaObject::invokeMethod(app, [j]() {
+				if (j->token)
+					j->token->cancel();
+			}, Qt::QueuedConnection);
+		}
+	}
+
+private:
+	QSharedPointer<CoverImageProvider::Job> job;
+	mutable QMutex mutex;
+	QImage image;
+	QString errorText;
+};
+
+QStringList variantExts()
+{
+	return {QStringLiteral("jpg"), QStringLiteral("png")};
+}
+
+}
+
+CoverImageProvider::CoverImageProvider(const FetchFunction &fetch, const MasterLookupFunction &lookupMaster)
+	: fetch(fetch)
+	, lookupMaster(lookupMaster)
+	, variants(QStringLiteral("covers"), 100LL * 1024 * 1024)
+{
+	decodePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+CoverImageProvider::~CoverImageProvider()
+{
+	decodePool.waitForDone();
+}
+
+QQuickImageResponse *CoverImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+	QSharedPointer<Job> job = QSharedPointer<Job>::create();
+	const int slash = id.lastIndexOf(QLatin1Char('/'));
+	bool sizeOk = false;
+	const int size = slash > 0 ? id.mid(slash + 1).toInt(&sizeOk) : 0;
+	job->url = QUrl(QUrl::fromPercentEncoding((sizeOk ? id.left(slash) : id).toUtf8()));
+	job->size = sizeOk ? size : qMax(requestedSize.width(), requestedSize.height());
+	CoverImageResponse *response = new CoverImageResponse(job);
+	// 本函数在图片加载线程上调用，缓存与网络请求回到 GUI 线程发起；结果总在返回之后交付
+	QMetaObject::invokeMethod(this, [this, job]() {
+		if (!job->url.isValid() || job->url.isEmpty())
+		{
+			job->finish(QImage(), QStringLiteral("Invalid cover url"));
+			return;
+		}
+		start(job);
+	}, Qt::QueuedConnection);
+	return response;
+}
+
+void CoverImageProvider::start(const QSharedPointer<Job> &job)
+{
+	if (job->isFinished())
+		return;
+	variants.resolveExisting(variantKey(job), variantExts(), [this, job](const QString &path) {
+		if (job->isFinished())
+			return;
+		if (!path.isEmpty())
+		{
+			// 缩略图已缓存：只解码小图
+			decodePool.start([job, path]() {
+				if (job->isFinished())
+					return;
+				QImageReader reader(path);
+				QImage image = reader.read();
+				if (image.isNull())
+					job->finish(QImage(), reader.errorString());
+				else
+					job->finish(image.hasAlphaChannel() ? image.convertToFormat(QImage::Format_ARGB32_Premultiplied) : image.convertToFormat(QImage::Format_RGB32));
+			});
+			return;
+		}
+		if (job->url.isLocalFile())
+		{
+			decodeFile(job, job->url.toLocalFile());
+			return;
+		}
+		if (!lookupMaster)
+		{
+			fetchRemote(job);
+			return;
+		}
+		// 母版边长不小于任何缩略图，命中时在本地缩放即可
+		lookupMaster(CoverUrl::canonicalKey(job->url), [this, job](const QString &masterPath) {
+			if (job->isFinished())
+				return;
+			if (masterPath.isEmpty())
+				fetchRemote(job);
+			else
+				decodeFile(job, masterPath);
+		});
+	});
+}
+
+// 没有母版时只请求所需尺寸，由图片服务端先缩小
+void CoverImageProvider::fetchRemote(const QSharedPointer<Job> &job)
+{
+	job->token = fetch(CoverUrl::sized(job->url, job->size), [this, job](Result<QByteArray> result) {
+		if (job->isFinished())
+			return;
+		if (!result.ok)
+		{
+			job->finish(QImage(), result.error.message);
+			return;
+		}
+		const QByteArray data = result.value;
+		decodePool.start([this, job, data]() {
+			if (!job->isFinished())
+				decodeAndStore(job, data);
+		});
+	});
+	if (job->token)
+		job->token->setPriority(RequestPriority::VisibleData);
+}
+
+void CoverImageProvider::decodeFile(const QSharedPointer<Job> &job, const QString &path)
+{
+	decodePool.start([this, job, path]() {
+		if (job->isFinished())
+			return;
+		QFile f(path);
+		if (!f.open(QIODevice::ReadOnly))
+		{
+			job->finish(QImage(), f.errorString());
+			return;
+		}
+		decodeAndStore(job, f.readAll());
+	});
+}
+
+// 工作线程上执行：缩放后立即交付，再编码写入缩略图缓存
+void CoverImageProvider::decodeAndStore(const QSharedPointer<Job> &job, const QByteArray &data)
+{
+	const QImage image = decodeScaled(data, job->size);
+	if (image.isNull())
+	{
+		job->finish(QImage(), QStringLiteral("Cover decode failed"));
+		return;
+	}
+	job->finish(image);
+
+	const bool alpha = image.hasAlphaChannel();
+	const QString ext = alpha ? QStringLiteral("png") : QStringLiteral("jpg");
+	QBuffer out;
+	out.open(QIODevice::WriteOnly);
+	QImageWriter writer(&out, alpha ? "PNG" : "JPEG");
+	if (!alpha)
+		writer.setQuality(90);
+	if (!writer.write(image))
+	{
+		Logger::warning(QStringLiteral("Cover thumbnail encode failed: %1").arg(writer.errorString()));
+		return;
+	}
+	variants.putWithExt(variantKey(job), out.data(), ext);
+}
+
+QImage CoverImageProvider::decodeScaled(const QByteArray &data, int size)
+{
+	QBuffer buf;
+	buf.setData(data);
+	buf.open(QIODevice::ReadOnly);
+	QImageReader reader(&buf);
+	reader.setAutoTransform(true);
+	const QSize full = reader.size();
+	if (size > 0 && full.isValid() && qMin(full.width(), full.height()) > size)
+	{
+		// JPEG 等格式可在解码时直接按比例缩小，避免先解出整张原图
+		const double scale = static_cast<double>(size) / qMin(full.width(), full.height());
+		reader.setScaledSize(QSize(qMax(1, qRound(full.width() * scale)), qMax(1, qRound(full.height() * scale))));
+	}
+	QImage image = reader.read();
+	if (image.isNull())
+		return image;
+	if (size > 0 && qMin(image.width(), image.height()) > size)
+		image = image.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+	// 转为可直接上传纹理的格式
+	return image.hasAlphaChannel() ? image.convertToFormat(QImage::Format_ARGB32_Premultiplied) : image.convertToFormat(QImage::Format_RGB32);
+}
+
+QString CoverImageProvider::variantKey(const QSharedPointer<Job> &job)
+{
+	return CoverUrl::canonicalKey(job->url) + QStringLiteral("#") + QString::number(job->size);
+}
+
+}
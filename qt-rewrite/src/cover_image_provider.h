@@ -0,0 +1,57 @@
+// CoverImageProvider：QML 封面图片提供者，image://cover/<key>/<size>
+// 解码与缩放在工作线程上完成，每种尺寸的缩略图单独写入磁盘缓存，列表滚动时不再解码原图
+// 缩略图按规范 key 缓存；本地已有母版时直接由母版派生，不再请求网络
+#pragma once
+
+#include <QImage>
+#include <QQuickAsyncImageProvider>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <functional>
+
+#include "async_disk_cache.h"
+#include "core_types.h"
+#include "http_client.h"
+
+namespace App
+{
+
+class CoverImageProvider : public QQuickAsyncImageProvider
+{
+	Q_OBJECT
+
+public:
+	// 下载封面原图，回调在 GUI 线程上执行
+	using FetchFunction = std::function<QSharedPointer<RequestToken>(const QUrl &url, const std::function<void(Result<QByteArray>)> &callback)>;
+	// 按规范 key 查找已缓存的母版文件，未命中时回调空路径；回调在 GUI 线程上执行
+	using MasterLookupFunction = std::function<void(const QString &canonicalKey, const std::function<void(const QString &path)> &callback)>;
+
+	CoverImageProvider(const FetchFunction &fetch, const MasterLookupFunction &lookupMaster);
+	~CoverImageProvider() override;
+
+	// id 为 "<百分号编码的封面地址>/<边长>"，由 QML 的图片加载线程调用
+	QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+	// 缩略图的最短边不小于 size，供 PreserveAspectCrop 裁剪；size <= 0 时保持原尺寸
+	static QImage decodeScaled(const QByteArray &data, int size);
+
+	struct Job;
+
+private:
+	FetchFunction fetch;
+	MasterLookupFunction lookupMaster;
+	// 缩略图磁盘缓存，key 为封面规范 key + 尺寸
+	AsyncDiskCache variants;
+	// 解码与缩放的工作线程；析构时先等待工作线程结束，再销毁磁盘缓存
+	QThreadPool decodePool;
+
+	void start(const QSharedPointer<Job> &job);
+	void fetchRemote(const QSharedPointer<Job> &job);
+	void decodeFile(const QSharedPointer<Job> &job, const QString &path);
+	void decodeAndStore(const QSharedPointer<Job> &job, const QByteArray &data);
+	static QString variantKey(const QSharedPointer<Job> &job);
+};
+
+}
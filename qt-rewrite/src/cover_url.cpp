@@ -0,0 +1,73 @@
+// 封面地址规范化实现
+#include "cover_url.h"
+
+#include <QRegularExpression>
+#include <QUrlQuery>
+
+namespace App
+{
+namespace CoverUrl
+{
+
+namespace
+{
+
+const QString kSizeParam = QStringLiteral("param");
+
+// 网易云图片服务：p1~p4 等节点内容相同，支持 ?param=NyN 由服务端缩放
+bool isNeteaseImageHost(const QString &host)
+{
+	return host.endsWith(QStringLiteral(".music.126.net"));
+}
+
+}
+
+QUrl canonical(const QUrl &url)
+{
+	if (!url.isValid() || url.isLocalFile() || !url.hasQuery())
+		return url;
+	QUrl u = url;
+	QUrlQuery q(u);
+	q.removeAllQueryItems(kSizeParam);
+	if (q.isEmpty())
+		u.setQuery(QString());
+	else
+		u.setQuery(q);
+	return u;
+}
+
+QString canonicalKey(const QUrl &url)
+{
+	QUrl u = canonical(url);
+	if (u.isLocalFile())
+		return u.toString();
+	const QString host = u.host().toLower();
+	static const QRegularExpression neteaseNode(QStringLiteral("^p\\d+\\.music\\.126\\.net$"));
+	if (neteaseNode.match(host).hasMatch())
+		u.setHost(QStringLiteral("p1.music.126.net"));
+	else
+		u.setHost(host);
+	return u.toString(QUrl::RemoveScheme | QUrl::RemoveUserInfo | QUrl::RemovePort);
+}
+
+QUrl sized(const QUrl &url, int size)
+{
+	QUrl u = canonical(url);
+	if (size <= 0 || u.isLocalFile())
+		return u;
+	// 原地址带过尺寸参数，或属于已知支持缩放的图片服务
+	if (!isNeteaseImageHost(u.host().toLower()) && !QUrlQuery(url).hasQueryItem(kSizeParam))
+		return u;
+	QUrlQuery q(u);
+	q.addQueryItem(kSizeParam, QStringLiteral("%1y%1").arg(size));
+	u.setQuery(q);
+	return u;
+}
+
+QUrl master(const QUrl &url)
+{
+	return sized(url, kMasterSize);
+}
+
+}
+}
@@ -0,0 +1,25 @@
+// 封面地址规范化：同一张封面在不同尺寸参数、不同 CDN 节点下共用一个缓存 key
+#pragma once
+
+#include <QString>
+#include <QUrl>
+
+namespace App
+{
+namespace CoverUrl
+{
+
+// 母版的边长：正在播放的大图使用，也用于在本地派生各尺寸缩略图
+constexpr int kMasterSize = 800;
+
+// 去掉尺寸参数后的地址，仍可直接请求
+QUrl canonical(const QUrl &url);
+// 封面的规范 key：在 canonical 的基础上忽略协议与 CDN 节点差异
+QString canonicalKey(const QUrl &url);
+// 请求指定边长的地址；图片服务不支持尺寸参数时返回 canonical 地址
+QUrl sized(const QUrl &url, int size);
+// 请求母版的地址
+QUrl master(const QUrl &url);
+
+}
+}
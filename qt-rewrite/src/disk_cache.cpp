@@ -1,21 +1,39 @@
 #include "disk_cache.h"
 
-#include <algorithm>
-
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QStandardPaths>
 
 namespace App
 {
 
+namespace
+{
+
+// 索引日志文件名，位于命名空间目录内，不计入缓存容量
+const QString kJournalName = QStringLiteral("index.journal");
+
+}
+
 DiskCache::DiskCache(const QString &namespaceName, qint64 maxBytes)
 	: ns(namespaceName.trimmed())
 	, maxSizeBytes(maxBytes)
 {
+	dirPath = QDir(rootDirPath()).filePath(ns.isEmpty() ? QStringLiteral("default") : ns);
+}
+
+DiskCache::~DiskCache()
+{
+	if (journal)
+	{
+		journal->close();
+		delete journal;
+		journal = nullptr;
+	}
 }
 
 QString DiskCache::rootDirPath() const
@@ -25,16 +43,15 @@ QString DiskCache::rootDirPath() const
 	return dir.filePath(QStringLiteral("cache"));
 }
 
+// 目录只检查创建一次，之后直接返回缓存的路径
 QString DiskCache::ensureDir() const
 {
-	QString root = rootDirPath();
-	QDir rootDir(root);
-	if (!rootDir.exists())
-		QDir().mkpath(root);
-	QString sub = rootDir.filePath(ns.isEmpty() ? QStringLiteral("default") : ns);
-	if (!QDir(sub).exists())
-		QDir().mkpath(sub);
-	return sub;
+	if (!dirReady)
+	{
+		QDir().mkpath(dirPath);
+		dirReady = true;
+	}
+	return dirPath;
 }
 
 QString DiskCache::sha1Hex(const QString &s)
@@ -44,11 +61,20 @@ QString DiskCache::sha1Hex(const QString &s)
 	return QString::fromLatin1(hash.toHex());
 }
 
+QString DiskCache::fileNameOf(const QString &filePath)
+{
+	return QFileInfo(filePath).fileName();
+}
+
+QString DiskCache::journalPath() const
+{
+	return QDir(ensureDir()).filePath(kJournalName);
+}
+
 QString DiskCache::filePathForKey(const QString &key) const
 {
-	QString dir = ensureDir();
 	QString name = sha1Hex(key);
-	return QDir(dir).filePath(name + QStringLiteral(".bin"));
+	return QDir(dirPath).filePath(name + QStringLiteral(".bin"));
 }
 
 QUrl DiskCache::fileUrlForKey(const QString &key) const
@@ -58,12 +84,11 @@ QUrl DiskCache::fileUrlForKey(const QString &key) const
 
 QString DiskCache::filePathForKeyExt(const QString &key, const QString &ext) const
 {
-	QString dir = ensureDir();
 	QString name = sha1Hex(key);
 	QString e = ext.trimmed().toLower();
 	if (e.isEmpty())
 		e = QStringLiteral("bin");
-	return QDir(dir).filePath(name + QStringLiteral(".") + e);
+	return QDir(dirPath).filePath(name + QStringLiteral(".") + e);
 }
 
 QUrl DiskCache::fileUrlForKeyExt(const QString &key, const QString &ext) const
@@ -89,22 +114,32 @@ bool DiskCache::containsAny(const QString &key, const QStringList &exts) const
 
 void DiskCache::touch(const QString &filePath)
 {
-	QFile f(filePath);
-	if (!f.exists())
+	ensureIndex();
+	const QString name = fileNameOf(filePath);
+	auto it = entries.constFind(name);
+	if (it == entries.constEnd())
+	{
+		// 索引之外的文件（如旧版本遗留）补登记
+		recordFile(filePath);
 		return;
-	QDateTime now = QDateTime::currentDateTime();
-	QFileDevice::FileTime when = QFileDevice::FileModificationTime;
-	f.setFileTime(now, when);
+	}
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	setEntry(name, it->size, now);
+	appendJournal(QByteArray("* ") + name.toUtf8() + ' ' + QByteArray::number(now) + '\n');
 }
 
 bool DiskCache::get(const QString &key, QByteArray &outData)
 {
 	QString path = filePathForKey(key);
 	QFile f(path);
-	if (!f.exists())
-		return false;
 	if (!f.open(QIODevice::ReadOnly))
+	{
+		// 文件已被外部删除时同步清理索引
+		ensureIndex();
+		if (entries.contains(fileNameOf(path)))
+			removeFile(path);
 		return false;
+	}
 	outData = f.readAll();
 	f.close();
 	touch(path);
@@ -113,65 +148,223 @@ bool DiskCache::get(const QString &key, QByteArray &outData)
 
 bool DiskCache::put(const QString &key, const QByteArray &data)
 {
-	QString path = filePathForKey(key);
-	QFile f(path);
-	QDir().mkpath(QFileInfo(path).absolutePath());
-	if (!f.open(QIODevice::WriteOnly))
+	return putWithExt(key, data, QStringLiteral("bin"));
+}
+
+// 先写日志再原子替换文件：崩溃时最多留下指向缺失文件的索引条目，不会出现截断的缓存内容
+bool DiskCache::putWithExt(const QString &key, const QByteArray &data, const QString &ext)
+{
+	ensureIndex();
+	QString path = filePathForKeyExt(key, ext);
+	const QString name = fileNameOf(path);
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	appendJournal(QByteArray("+ ") + name.toUtf8() + ' ' + QByteArray::number(data.size()) + ' ' + QByteArray::number(now) + '\n');
+	if (!writeAtomically(path, data))
+	{
+		removeFile(path);
 		return false;
-	f.write(data);
-	f.close();
-	touch(path);
+	}
+	setEntry(name, data.size(), now);
 	prune();
 	return true;
 }
 
-bool DiskCache::putWithExt(const QString &key, const QByteArray &data, const QString &ext)
+bool DiskCache::writeAtomically(const QString &path, const QByteArray &data)
 {
-	QString path = filePathForKeyExt(key, ext);
-	QFile f(path);
-	QDir().mkpath(QFileInfo(path).absolutePath());
+	QSaveFile f(path);
 	if (!f.open(QIODevice::WriteOnly))
 		return false;
-	f.write(data);
-	f.close();
-	touch(path);
+	if (f.write(data) != data.size())
+	{
+		f.cancelWriting();
+		f.commit();
+		return false;
+	}
+	return f.commit();
+}
+
+void DiskCache::recordFile(const QString &filePath)
+{
+	ensureIndex();
+	QFileInfo info(filePath);
+	const QString name = info.fileName();
+	if (!info.exists())
+	{
+		if (entries.contains(name))
+		{
+			removeEntry(name);
+			appendJournal(QByteArray("- ") + name.toUtf8() + '\n');
+		}
+		return;
+	}
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	setEntry(name, info.size(), now);
+	appendJournal(QByteArray("+ ") + name.toUtf8() + ' ' + QByteArray::number(info.size()) + ' ' + QByteArray::number(now) + '\n');
+	prune();
+}
+
+void DiskCache::removeFile(const QString &filePath)
+{
+	ensureIndex();
+	QFile::remove(filePath);
+	const QString name = fileNameOf(filePath);
+	if (!entries.contains(name))
+		return;
+	removeEntry(name);
+	appendJournal(QByteArray("- ") + name.toUtf8() + '\n');
+}
+
+qint64 DiskCache::totalBytes() const
+{
+	return total;
+}
+
+// 按最近访问时间从最旧的条目开始淘汰，直到总大小回到上限以内
+void DiskCache::prune()
+{
+	if (maxSizeBytes <= 0)
+		return;
+	ensureIndex();
+	if (total <= maxSizeBytes)
+		return;
+	const QString dir = ensureDir();
+	while (total > maxSizeBytes && !lruOrder.empty())
+	{
+		const QString name = lruOrder.begin()->second;
+		QFile::remove(QDir(dir).filePath(name));
+		removeEntry(name);
+		appendJournal(QByteArray("- ") + name.toUtf8() + '\n');
+	}
+}
+
+void DiskCache::ensureIndex()
+{
+	if (indexLoaded)
+		return;
+	indexLoaded = true;
+
+	QFile f(journalPath());
+	if (!f.exists())
+	{
+		// 首次启动或从无索引的旧版本升级：遍历一次目录建立索引
+		rebuildIndex();
+		compactJournal();
+		return;
+	}
+	if (f.open(QIODevice::ReadOnly))
+	{
+		while (!f.atEnd())
+		{
+			const QByteArray line = f.readLine().trimmed();
+			const QList<QByteArray> parts = line.split(' ');
+			++journalRecords;
+			// 崩溃时最后一行可能不完整，格式不对的记录直接跳过
+			if (parts.size() == 4 && parts.at(0) == "+")
+			{
+				bool sizeOk = false;
+				bool timeOk = false;
+				const qint64 size = parts.at(2).toLongLong(&sizeOk);
+				const qint64 at = parts.at(3).toLongLong(&timeOk);
+				if (sizeOk && timeOk)
+					setEntry(QString::fromUtf8(parts.at(1)), size, at);
+			}
+			else if (parts.size() == 3 && parts.at(0) == "*")
+			{
+				const QString name = QString::fromUtf8(parts.at(1));
+				bool ok = false;
+				const qint64 at = parts.at(2).toLongLong(&ok);
+				auto it = entries.constFind(name);
+				if (ok && it != entries.constEnd())
+					setEntry(name, it->size, at);
+			}
+			else if (parts.size() == 2 && parts.at(0) == "-")
+			{
+				removeEntry(QString::fromUtf8(parts.at(1)));
+			}
+		}
+		f.close();
+	}
+	journal = new QFile(journalPath());
+	if (!journal->open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		delete journal;
+		journal = nullptr;
+	}
 	prune();
-	return true;
 }
 
-qint64 DiskCache::computeTotalBytes(QList<QFileInfo> &outFiles) const
+void DiskCache::rebuildIndex()
 {
 	QString dir = ensureDir();
-	QDirIterator it(dir, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-	qint64 total = 0;
+	QDirIterator it(dir, QDir::Files | QDir::NoDotAndDotDot);
 	while (it.hasNext())
 	{
 		it.next();
 		QFileInfo info = it.fileInfo();
-		outFiles.append(info);
-		total += info.size();
+		if (info.fileName() == kJournalName)
+			continue;
+		setEntry(info.fileName(), info.size(), info.lastModified().toMSecsSinceEpoch());
 	}
-	return total;
 }
 
-void DiskCache::prune()
+void DiskCache::setEntry(const QString &name, qint64 size, qint64 lastAccess)
 {
-	if (maxSizeBytes <= 0)
+	removeEntry(name);
+	Entry e;
+	e.size = size;
+	e.lastAccess = lastAccess;
+	e.seq = ++nextSeq;
+	entries.insert(name, e);
+	lruOrder.emplace(OrderKey(e.lastAccess, e.seq), name);
+	total += size;
+}
+
+void DiskCache::removeEntry(const QString &name)
+{
+	auto it = entries.find(name);
+	if (it == entries.end())
 		return;
-	QList<QFileInfo> files;
-	qint64 total = computeTotalBytes(files);
-	if (total <= maxSizeBytes)
+	lruOrder.erase(OrderKey(it->lastAccess, it->seq));
+	total -= it->size;
+	entries.erase(it);
+}
+
+void DiskCache::appendJournal(const QByteArray &record)
+{
+	if (!journal)
 		return;
-	std::sort(files.begin(), files.end(), [](const QFileInfo &a, const QFileInfo &b) {
-		return a.lastModified() < b.lastModified();
-	});
-	for (const QFileInfo &fi : files)
-	{
-		if (total <= maxSizeBytes)
-			break;
-		qint64 size = fi.size();
-		QFile::remove(fi.absoluteFilePath());
-		total -= size;
+	journal->write(record);
+	journal->flush();
+	++journalRecords;
+	if (journalRecords > entries.size() * 2 + 512)
+		compactJournal();
+}
+
+void DiskCache::compactJournal()
+{
+	if (journal)
+	{
+		journal->close();
+		delete journal;
+		journal = nullptr;
+	}
+	QSaveFile f(journalPath());
+	if (f.open(QIODevice::WriteOnly))
+	{
+		// 按访问顺序写出，回放后淘汰顺序保持一致
+		for (const auto &item : lruOrder)
+		{
+			const Entry &e = entries.value(item.second);
+			f.write(QByteArray("+ ") + item.second.toUtf8() + ' ' + QByteArray::number(e.size) + ' ' + QByteArray::number(e.lastAccess) + '\n');
+		}
+		f.commit();
+	}
+	journalRecords = entries.size();
+	journal = new QFile(journalPath());
+	if (!journal->open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		delete journal;
+		journal = nullptr;
 	}
 }
 
@@ -2,18 +2,29 @@
 
 #include <QByteArray>
 #include <QDir>
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 
+#include <map>
+#include <utility>
+
+class QFile;
+
 namespace App
 {
 
+// 磁盘缓存：每个命名空间一个目录，按最近使用时间淘汰
+// 条目大小与访问时间记录在索引日志中，写入与淘汰无需遍历目录
+// 非线程安全：GUI 线程上请通过 AsyncDiskCache 使用；路径计算函数不访问磁盘，可在任意线程调用
 class DiskCache
 {
 public:
 	explicit DiskCache(const QString &namespaceName, qint64 maxBytes);
+	~DiskCache();
+	Q_DISABLE_COPY(DiskCache)
 
 	QString rootDirPath() const;
 	QString filePathForKey(const QString &key) const;
@@ -29,15 +40,53 @@ public:
 	bool put(const QString &key, const QByteArray &data);
 	bool putWithExt(const QString &key, const QByteArray &data, const QString &ext);
 	void prune();
+	// 刷新文件的使用时间，prune 时按该时间淘汰最久未用的文件
+	void touch(const QString &filePath);
+	// 登记由外部直接写入缓存目录的文件（如下载中的部分文件），按当前大小计入容量
+	void recordFile(const QString &filePath);
+	// 删除文件并移除索引条目
+	void removeFile(const QString &filePath);
+	// 当前索引中的总字节数
+	qint64 totalBytes() const;
 
 private:
+	// 索引条目：文件名（不含目录）-> 大小与最近访问时间
+	struct Entry
+	{
+		qint64 size = 0;
+		qint64 lastAccess = 0;
+		quint64 seq = 0;
+	};
+	// 淘汰顺序：(最近访问时间, 序号) 升序，begin() 即最久未用
+	using OrderKey = std::pair<qint64, quint64>;
+
 	QString ns;
 	qint64 maxSizeBytes = 0;
+	// 命名空间目录在构造时确定，首次写入前才创建
+	QString dirPath;
+	mutable bool dirReady = false;
+
+	bool indexLoaded = false;
+	QHash<QString, Entry> entries;
+	std::map<OrderKey, QString> lruOrder;
+	qint64 total = 0;
+	quint64 nextSeq = 0;
+	QFile *journal = nullptr;
+	int journalRecords = 0;
 
 	QString ensureDir() const;
 	static QString sha1Hex(const QString &s);
-	void touch(const QString &filePath);
-	qint64 computeTotalBytes(QList<QFileInfo> &outFiles) const;
+	static QString fileNameOf(const QString &filePath);
+	// 首次使用时加载索引：回放日志；日志不存在时遍历一次目录重建
+	void ensureIndex();
+	void rebuildIndex();
+	void setEntry(const QString &name, qint64 size, qint64 lastAccess);
+	void removeEntry(const QString &name);
+	void appendJournal(const QByteArray &record);
+	// 日志记录远多于条目数时，用当前索引快照原子替换日志
+	void compactJournal();
+	bool writeAtomically(const QString &path, const QByteArray &data);
+	QString journalPath() const;
 };
 
 }
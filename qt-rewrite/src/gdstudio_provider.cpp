@@ -149,6 +149,7 @@ QSharedPointer<RequestToken> GdStudioProvider::playUrl(const QString &songId, co
 	}
 
 	HttpRequestOptions opts;
+	opts.priority = RequestPriority::Playback;
 	QUrl url = apiBase;
 	QUrlQuery q;
 	q.addQueryItem(QStringLiteral("types"), QStringLiteral("url"));
@@ -335,6 +336,7 @@ Result<PlayUrl> GdStudioProvider::parsePlayUrl(const QByteArray &body) const
 	Result<qint64> size = Json::readInt64(o, QStringLiteral("size"), false);
 	if (size.ok)
 		p.size = size.value;
+	p.strategy = QStringLiteral("gdstudio");
 	return Result<PlayUrl>::success(p);
 }
 
@@ -17,6 +17,7 @@ public:
 
 	QString id() const override;
 	QString displayName() const override;
+	QList<QUrl> warmUpOrigins() const override { return {apiBase}; }
 	bool supportsSongDetail() const override;
 	bool supportsLyric() const override;
 	bool supportsCover() const override;
@@ -3,15 +3,98 @@
 
 #include "logger.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QNetworkCookieJar>
+#include <QNetworkInformation>
+#include <QRandomGenerator>
+#include <QSslConfiguration>
 #include <QUrlQuery>
 #include <QTimer>
 
+#include <algorithm>
+
 namespace App
 {
 
+namespace
+{
+
+constexpr quint32 kCacheFormatVersion = 1;
+// 内存缓存的字节预算：整页歌单等大响应体也会进入缓存，按正文与响应头大小计费
+constexpr qint64 kMemoryCacheMaxBytes = 32LL * 1024 * 1024;
+
+// 端点延迟统计参数
+constexpr int kLatencyWindow = 64;
+constexpr double kLatencyEwmaAlpha = 0.2;
+constexpr int kMinLatencySamples = 8;
+constexpr int kMinAdaptiveTimeoutMs = 3000;
+// 重试预算：最多积攒 10 次重试，每个完成的网络请求补充 0.1 次，即稳态下重试不超过流量的 10%
+constexpr double kRetryBudgetMax = 10.0;
+constexpr double kRetryBudgetRatio = 0.1;
+constexpr int kMaxBackoffMs = 8000;
+// 续热间隔略短于 Qt 连接缓存的空闲回收时间；只续热近期用过的主机
+constexpr int kKeepWarmIntervalMs = 100 * 1000;
+constexpr qint64 kKeepWarmIdleLimitMs = 5 * 60 * 1000;
+
+QByteArray findHeader(const QMap<QByteArray, QByteArray> &headers, const QByteArray &name)
+{
+	for (auto it = headers.cbegin(); it != headers.cend(); ++it)
+	{
+		if (it.key().compare(name, Qt::CaseInsensitive) == 0)
+			return it.value();
+	}
+	return QByteArray();
+}
+
+thread_local QDeadlineTimer scopedDeadline{QDeadlineTimer::Forever};
+
+Error makeCancelledError()
+{
+	Error e;
+	e.category = ErrorCategory::Network;
+	e.code = -2;
+	e.message = QStringLiteral("Request cancelled");
+	return e;
+}
+
+// 流式调用方拿到的是整体响应（缓存命中或合并到普通请求）时，把 2xx 的 body 作为唯一的数据块交付
+HttpCallback deliverAsSingleChunk(const HttpChunkCallback &onChunk, const HttpCallback &callback)
+{
+	return [onChunk, callback](Result<HttpResponse> result) {
+		if (result.ok && result.value.statusCode > 0 && result.value.statusCode < 300)
+		{
+			if (!result.value.body.isEmpty())
+				onChunk(result.value.body);
+			result.value.body.clear();
+		}
+		callback(result);
+	};
+}
+
+}
+
+HttpDeadlineScope::HttpDeadlineScope(const QDeadlineTimer &deadline)
+	: previous(scopedDeadline)
+{
+	// 嵌套作用域取较早的截止时间
+	if (previous.isForever() || (!deadline.isForever() && deadline < previous))
+		scopedDeadline = deadline;
+}
+
+HttpDeadlineScope::~HttpDeadlineScope()
+{
+	scopedDeadline = previous;
+}
+
+QDeadlineTimer HttpDeadlineScope::current()
+{
+	return scopedDeadline;
+}
+
 // 取消令牌构造函数
 RequestToken::RequestToken(QObject *parent)
 	: QObject(parent)
@@ -33,12 +116,67 @@ bool RequestToken::isCancelled() const
 	return cancelledFlag;
 }
 
+// 调整请求优先级，变化时通知排队中的请求与下游令牌
+void RequestToken::setPriority(RequestPriority priority)
+{
+	if (prioritySet && currentPriority == priority)
+		return;
+	prioritySet = true;
+	currentPriority = priority;
+	emit priorityChanged(priority);
+}
+
+RequestPriority RequestToken::priority() const
+{
+	return currentPriority;
+}
+
+bool RequestToken::hasPriority() const
+{
+	return prioritySet;
+}
+
+qint64 HttpClient::cachedResponseCost(const CachedResponse &cached)
+{
+	qint64 cost = sizeof(CachedResponse) + cached.response.body.size();
+	for (auto it = cached.response.headers.cbegin(); it != cached.response.headers.cend(); ++it)
+		cost += it.key().size() + it.value().size();
+	return cost;
+}
+
 // 构造 HttpClient，配置默认重定向策略
 HttpClient::HttpClient(QObject *parent)
 	: QObject(parent)
+	, memoryCache(512, 10 * 60 * 1000, kMemoryCacheMaxBytes, &HttpClient::cachedResponseCost)
+	, diskCache(QStringLiteral("http"), 64LL * 1024 * 1024)
+	, retryTokens(kRetryBudgetMax)
 {
 	manager.setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
 	manager.setCookieJar(new QNetworkCookieJar(this));
+
+	keepWarmTimer = new QTimer(this);
+	keepWarmTimer->setInterval(kKeepWarmIntervalMs);
+	QObject::connect(keepWarmTimer, &QTimer::timeout, this, [this]() { keepWarm(); });
+
+	// 网络切换（断网恢复、Wi-Fi 与蜂窝切换）后旧连接多半已失效，清掉连接缓存并重新预热
+	networkChangeTimer = new QTimer(this);
+	networkChangeTimer->setSingleShot(true);
+	networkChangeTimer->setInterval(1000);
+	QObject::connect(networkChangeTimer, &QTimer::timeout, this, [this]() {
+		QNetworkInformation *info = QNetworkInformation::instance();
+		if (info && info->reachability() != QNetworkInformation::Reachability::Online)
+			return;
+		Logger::info(QStringLiteral("Network changed, re-warming connections"));
+		manager.clearConnectionCache();
+		warmedHosts.clear();
+		warmUp();
+	});
+	if (QNetworkInformation::loadDefaultBackend())
+	{
+		QNetworkInformation *info = QNetworkInformation::instance();
+		QObject::connect(info, &QNetworkInformation::reachabilityChanged, this, [this]() { networkChangeTimer->start(); });
+		QObject::connect(info, &QNetworkInformation::transportMediumChanged, this, [this]() { networkChangeTimer->start(); });
+	}
 }
 
 // 设置默认请求头
@@ -63,9 +201,92 @@ void HttpClient::setFollowRedirects(bool enabled)
 		manager.setRedirectPolicy(QNetworkRequest::ManualRedirectPolicy);
 }
 
+// 设置缓存作用域，切换用户后自动使用新的缓存空间
+void HttpClient::setCacheScope(const QString &scope)
+{
+	if (cacheScope == scope)
+		return;
+	cacheScope = scope;
+	Logger::debug(QStringLiteral("HTTP cache scope: %1").arg(scope.isEmpty() ? QStringLiteral("<anonymous>") : scope));
+}
+
+// 记录标签失效时间并落盘，保证重启后旧缓存也不会被直接使用
+void HttpClient::invalidateCache(const QString &tag)
+{
+	if (tag.isEmpty())
+		return;
+	const QString scopedTag = cacheScope + QStringLiteral("|") + tag;
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	tagInvalidatedAt.insert(scopedTag, now);
+	diskCache.put(QStringLiteral("tag:") + scopedTag, QByteArray::number(now));
+}
+
+// 设置预热源，只保留 scheme + host + port
+void HttpClient::setWarmUpOrigins(const QList<QUrl> &origins)
+{
+	warmUpOriginList.clear();
+	QSet<QString> seen;
+	for (const QUrl &url : origins)
+	{
+		if (!url.isValid() || url.host().isEmpty())
+			continue;
+		const QString host = hostKey(url);
+		if (seen.contains(host))
+			continue;
+		seen.insert(host);
+		QUrl origin;
+		origin.setScheme(url.scheme());
+		origin.setHost(url.host());
+		origin.setPort(url.port());
+		warmUpOriginList.append(origin);
+	}
+	if (!warmUpOriginList.isEmpty())
+		keepWarmTimer->start();
+	else
+		keepWarmTimer->stop();
+}
+
+void HttpClient::warmUp()
+{
+	for (const QUrl &origin : warmUpOriginList)
+		warmUpOrigin(origin);
+}
+
+void HttpClient::warmUpOrigin(const QUrl &origin)
+{
+	const QString host = origin.host();
+	if (origin.scheme() == QStringLiteral("https"))
+	{
+#ifndef QT_NO_SSL
+		QSslConfiguration ssl = QSslConfiguration::defaultConfiguration();
+		ssl.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::NextProtocolHttp1_1});
+		manager.connectToHostEncrypted(host, static_cast<quint16>(origin.port(443)), ssl);
+#endif
+	}
+	else
+	{
+		manager.connectToHost(host, static_cast<quint16>(origin.port(80)));
+	}
+	warmedHosts.insert(hostKey(origin));
+	Logger::debug(QStringLiteral("HTTP warm-up: %1").arg(hostKey(origin)));
+}
+
+void HttpClient::keepWarm()
+{
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	for (const QUrl &origin : warmUpOriginList)
+	{
+		const qint64 lastUsed = lastUsedByHost.value(hostKey(origin));
+		if (lastUsed > 0 && now - lastUsed < kKeepWarmIdleLimitMs)
+			warmUpOrigin(origin);
+	}
+}
+
 // 将默认头与请求头合并写入 QNetworkRequest
 void HttpClient::applyHeaders(QNetworkRequest &request, const HttpRequestOptions &options)
 {
+	// 服务端支持时通过 ALPN 协商 HTTP/2，同一主机的请求复用一条连接多路传输
+	request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
 	for (auto it = defaultHeaders.cbegin(); it != defaultHeaders.cend(); ++it)
 		request.setRawHeader(it.key(), it.value());
 	for (auto it = options.headers.cbegin(); it != options.headers.cend(); ++it)
@@ -78,13 +299,24 @@ void HttpClient::applyHeaders(QNetworkRequest &request, const HttpRequestOptions
 QSharedPointer<RequestToken> HttpClient::send(const HttpRequestOptions &options, const HttpCallback &callback)
 {
 	QSharedPointer<RequestToken> token = QSharedPointer<RequestToken>::create();
-	sendOnce(options, token, callback);
+	sendOnce(withScopedDeadline(options), token, callback);
 	return token;
 }
 
-// 发起带重试逻辑的请求，支持指数退避与取消
-QSharedPointer<RequestToken> HttpClient::sendWithRetry(const HttpRequestOptions &options, int maxRetries, int baseDelayMs, const HttpCallback &callback)
+HttpRequestOptions HttpClient::withScopedDeadline(const HttpRequestOptions &options)
 {
+	const QDeadlineTimer scoped = HttpDeadlineScope::current();
+	if (scoped.isForever() || (!options.deadline.isForever() && options.deadline < scoped))
+		return options;
+	HttpRequestOptions merged = options;
+	merged.deadline = scoped;
+	return merged;
+}
+
+// 发起带重试逻辑的请求，支持 full jitter 退避、全局重试预算、截止时间与取消
+QSharedPointer<RequestToken> HttpClient::sendWithRetry(const HttpRequestOptions &requestOptions, int maxRetries, int baseDelayMs, const HttpCallback &callback)
+{
+	const HttpRequestOptions options = withScopedDeadline(requestOptions);
 	QSharedPointer<RequestToken> token = QSharedPointer<RequestToken>::create();
 	QSharedPointer<bool> finished = QSharedPointer<bool>::create(false);
 	QSharedPointer<int> attempt = QSharedPointer<int>::create(0);
@@ -108,31 +340,40 @@ QSharedPointer<RequestToken> HttpClient::sendWithRetry(const HttpRequestOptions
 			return;
 		}
 		// 执行一次真实请求，并在回调中决定是否重试
-		sendOnce(options, token, [this, maxRetries, baseDelayMs, callback, token, finished, attempt, retryFn](Result<HttpResponse> result) {
-			// 不需要重试或已达上限 / 已取消，直接结束
-			if (!isRetryable(result) || *attempt >= maxRetries || token->isCancelled())
-			{
+		sendOnce(options, token, [this, options, maxRetries, baseDelayMs, callback, token, finished, attempt, retryFn](Result<HttpResponse> result) {
+			auto finish = [&]() {
 				if (*finished)
 					return;
 				*finished = true;
 				callback(result);
+			};
+			// 不需要重试或已达上限 / 已取消，直接结束
+			if (!isRetryable(result) || *attempt >= maxRetries || token->isCancelled())
+			{
+				finish();
 				return;
 			}
-			// 增加重试次数
-			(*attempt)++;
-			int base = baseDelayMs > 0 ? baseDelayMs : 0;
-			// 指数退避系数，最大放大到 16 倍
-			qint64 factor = 1;
-			for (int i = 1; i < *attempt; ++i)
+			// full jitter：在 [0, min(上限, base * 2^n)] 内随机等待，避免大量请求同时重试
+			const int base = baseDelayMs > 0 ? baseDelayMs : 0;
+			qint64 ceiling = base;
+			for (int i = 0; i < *attempt && ceiling < kMaxBackoffMs; ++i)
+				ceiling *= 2;
+			ceiling = qMin<qint64>(ceiling, kMaxBackoffMs);
+			const int delay = ceiling > 0 ? static_cast<int>(QRandomGenerator::global()->bounded(ceiling + 1)) : 0;
+			// 截止时间内已来不及再完成一次请求，调用方不再关心结果
+			if (!options.deadline.isForever() && options.deadline.remainingTime() <= delay)
 			{
-				factor *= 2;
-				if (factor > 16)
-				{
-					factor = 16;
-					break;
-				}
+				Logger::debug(QStringLiteral("HTTP retry skipped, deadline reached: %1").arg(options.url.path()));
+				finish();
+				return;
 			}
-			int delay = base * static_cast<int>(factor);
+			if (!takeRetryToken())
+			{
+				Logger::warning(QStringLiteral("HTTP retry budget exhausted, not retrying: %1").arg(options.url.path()));
+				finish();
+				return;
+			}
+			(*attempt)++;
 			QTimer::singleShot(delay, this, [retryFn]() {
 				(*retryFn)();
 			});
@@ -142,8 +383,16 @@ QSharedPointer<RequestToken> HttpClient::sendWithRetry(const HttpRequestOptions
 	return token;
 }
 
+// 发起流式请求，单次尝试，不做重试
+QSharedPointer<RequestToken> HttpClient::sendStreaming(const HttpRequestOptions &options, const HttpChunkCallback &onChunk, const HttpCallback &callback)
+{
+	QSharedPointer<RequestToken> token = QSharedPointer<RequestToken>::create();
+	sendOnce(withScopedDeadline(options), token, callback, onChunk);
+	return token;
+}
+
 // 执行一次实际网络请求，供单次请求和重试流程复用
-void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback)
+void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk)
 {
 	// URL 不合法时立即返回错误，避免发送错误请求
 	if (!options.url.isValid())
@@ -167,13 +416,70 @@ void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointe
 		return;
 	}
 
+	// 截止时间已过，调用方不再等待结果
+	if (!options.deadline.isForever() && options.deadline.hasExpired())
+	{
+		Error e;
+		e.category = ErrorCategory::Network;
+		e.code = static_cast<int>(QNetworkReply::TimeoutError);
+		e.message = QStringLiteral("Request timeout");
+		callback(Result<HttpResponse>::failure(e));
+		return;
+	}
+
+	// 根据 method 选择 GET/POST/PUT
+	const QByteArray method = options.method.isEmpty() ? QByteArray("GET") : options.method.toUpper();
+	// 流式请求的总耗时取决于响应体大小，不使用自适应超时
+	int timeoutMs = onChunk ? (options.timeoutMs > 0 ? options.timeoutMs : 15000) : effectiveTimeout(options);
+
+	if (options.cache.enabled && method == "GET")
+	{
+		if (onChunk)
+			sendStreamingCached(method, options, token, callback, onChunk);
+		else
+			sendCached(method, options, token, callback);
+		return;
+	}
+
+	// 相同的 GET 请求正在进行时直接挂到已有 reply 上，避免重复请求；
+	// 流式调用方也可以挂到普通请求上，完成时整体交付。流式请求本身不登记，之后的调用方无法补收已交付的数据块
+	const QByteArray coalesceKey = (options.coalesce && method == "GET") ? requestKey(method, options) : QByteArray();
+	if (!coalesceKey.isEmpty())
+	{
+		auto it = inFlight.constFind(coalesceKey);
+		if (it != inFlight.constEnd())
+		{
+			QSharedPointer<InFlightRequest> flight = it.value();
+			Logger::debug(QStringLiteral("HTTP coalesced %1 %2 (waiters %3%4)")
+							  .arg(QString::fromLatin1(method))
+							  .arg(options.url.path())
+							  .arg(flight->waiters.size() + 1)
+							  .arg(onChunk ? QStringLiteral(", streaming") : QString()));
+			attachWaiter(flight, token, onChunk ? deliverAsSingleChunk(onChunk, callback) : callback, timeoutMs);
+			return;
+		}
+	}
+	const QByteArray key = onChunk ? QByteArray() : coalesceKey;
+
+	// 目标主机并发已满时进入优先级队列，等待空闲连接
+	const QString host = hostKey(options.url);
+	if (activeByHost.value(host) >= maxConnectionsPerHost)
+	{
+		enqueue(host, method, key, options, token, callback, onChunk, timeoutMs);
+		return;
+	}
+
+	dispatch(host, method, key, options, token, callback, onChunk, timeoutMs);
+}
+
+// 真正发出请求并占用一个主机连接名额，完成后释放名额并调度队列
+void HttpClient::dispatch(const QString &host, const QByteArray &method, const QByteArray &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk, int timeoutMs)
+{
 	// 构造 QNetworkRequest 并写入请求头
 	QNetworkRequest request(options.url);
 	applyHeaders(request, options);
 
-	// 根据 method 选择 GET/POST/PUT
 	QNetworkReply *reply = nullptr;
-	const QByteArray method = options.method.isEmpty() ? QByteArray("GET") : options.method.toUpper();
 	
 	QUrl logUrl = options.url;
 	if (logUrl.hasQuery()) {
@@ -193,28 +499,66 @@ void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointe
 	else
 		reply = manager.get(request);
 
-	// 启用请求级别的超时控制
-	int timeoutMs = options.timeoutMs > 0 ? options.timeoutMs : 15000;
-	QTimer *timer = new QTimer(reply);
-	timer->setSingleShot(true);
-	QObject::connect(timer, &QTimer::timeout, reply, [reply]() {
-		if (reply->isRunning())
-			reply->abort();
-	});
-	timer->start(timeoutMs);
+	activeByHost[host]++;
+	dispatchedTotal++;
 
-	// 将取消令牌与当前 reply 绑定，保证取消操作能立即中止请求
-	if (token)
+	QSharedPointer<InFlightRequest> flight = QSharedPointer<InFlightRequest>::create();
+	flight->key = key;
+	flight->reply = reply;
+	flight->onChunk = onChunk;
+	flight->endpoint = endpointKey(options.url);
+	flight->startedAt = QDateTime::currentMSecsSinceEpoch();
+	lastUsedByHost.insert(host, flight->startedAt);
+
+	// 记录每个主机首个请求的 TTFB，用于对比预热前后的首包耗时
+	if (!ttfbLoggedHosts.contains(host))
+	{
+		ttfbLoggedHosts.insert(host);
+		const bool warmed = warmedHosts.contains(host);
+		QObject::connect(reply, &QNetworkReply::metaDataChanged, reply, [reply, flight, host, warmed]() {
+			if (flight->ttfbLogged)
+				return;
+			flight->ttfbLogged = true;
+			Logger::info(QStringLiteral("HTTP first request TTFB %1: %2 ms (pre-warmed: %3, HTTP/2: %4)")
+							 .arg(host)
+							 .arg(QDateTime::currentMSecsSinceEpoch() - flight->startedAt)
+							 .arg(warmed ? QStringLiteral("yes") : QStringLiteral("no"))
+							 .arg(reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool() ? QStringLiteral("yes") : QStringLiteral("no")));
+		});
+	}
+	if (!key.isEmpty())
+		inFlight.insert(key, flight);
+
+	// 流式请求：2xx 响应的数据到达即交付；错误响应保留在 reply 中，完成时整体返回供上层解析
+	if (onChunk)
 	{
-		QObject::connect(token.data(), &RequestToken::cancelled, reply, [reply]() {
-			if (reply->isRunning())
-				reply->abort();
+		QObject::connect(reply, &QNetworkReply::readyRead, reply, [reply, flight]() {
+			const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+			if (status >= 300 || flight->waiters.isEmpty())
+				return;
+			const QByteArray chunk = reply->readAll();
+			if (chunk.isEmpty())
+				return;
+			flight->streamedBytes += chunk.size();
+			flight->onChunk(chunk);
 		});
 	}
 
-	// 统一处理请求完成（成功或失败）逻辑
-	QObject::connect(reply, &QNetworkReply::finished, reply, [reply, timer, callback]() {
-		timer->stop();
+	// 排队期间可能已消耗掉部分截止时间
+	if (!options.deadline.isForever())
+		timeoutMs = static_cast<int>(qBound<qint64>(1, options.deadline.remainingTime(), timeoutMs));
+
+	// 超时与取消按调用方分别计时，只有全部调用方离开才中止 reply
+	attachWaiter(flight, token, callback, timeoutMs);
+
+	// 统一处理请求完成（成功或失败）逻辑，结果分发给所有仍在等待的调用方
+	QObject::connect(reply, &QNetworkReply::finished, reply, [this, reply, flight, host]() {
+		if (!flight->key.isEmpty() && inFlight.value(flight->key) == flight)
+			inFlight.remove(flight->key);
+		if (--activeByHost[host] <= 0)
+			activeByHost.remove(host);
+		// 每个完成的网络请求（含普通、流式与缓存刷新）都为重试预算存入令牌，使重试占全部流量的比例有上限
+		retryTokens = qMin(kRetryBudgetMax, retryTokens + kRetryBudgetRatio);
 
 		HttpResponse response;
 		response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
@@ -223,11 +567,27 @@ void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointe
 			response.headers.insert(name, reply->rawHeader(name));
 		if (reply->isOpen())
 			response.body = reply->readAll();
+		// 收到服务端响应才计入延迟样本；流式请求的耗时取决于响应体大小，不参与统计
+		if (response.statusCode > 0 && !flight->onChunk && !flight->latencyRecorded)
+		{
+			flight->latencyRecorded = true;
+			recordLatency(flight->endpoint, QDateTime::currentMSecsSinceEpoch() - flight->startedAt);
+		}
+		if (flight->onChunk && response.statusCode > 0 && response.statusCode < 300 && reply->error() == QNetworkReply::NoError)
+		{
+			if (!response.body.isEmpty() && !flight->waiters.isEmpty())
+			{
+				flight->streamedBytes += response.body.size();
+				flight->onChunk(response.body);
+			}
+			response.body.clear();
+		}
 
 		// 将 Qt 的网络错误转换为统一的 Error 对象
 		// 注意：对于 HTTP 4xx/5xx 错误，Qt 可能会设置 error()，但我们也希望返回 body 供上层解析
 		// 因此仅当 status code 为 0 (完全失败) 或确实是底层网络错误时才视为 failure
 		bool isHttpError = response.statusCode >= 400;
+		Result<HttpResponse> result;
 		if (reply->error() != QNetworkReply::NoError && !isHttpError)
 		{
 			Error e;
@@ -235,20 +595,540 @@ void HttpClient::sendOnce(const HttpRequestOptions &options, const QSharedPointe
 			e.code = static_cast<int>(reply->error());
 			e.message = reply->errorString();
 			e.detail = QString::number(response.statusCode);
-			Logger::warning(QStringLiteral("HTTP failed: %1 (status %2)").arg(e.message).arg(response.statusCode));
-			callback(Result<HttpResponse>::failure(e));
+			if (!flight->waiters.isEmpty())
+				Logger::warning(QStringLiteral("HTTP failed: %1 (status %2)").arg(e.message).arg(response.statusCode));
+			result = Result<HttpResponse>::failure(e);
 		}
 		else
 		{
 			if (isHttpError)
 				Logger::warning(QStringLiteral("HTTP error response: status %1, body: %2").arg(response.statusCode).arg(QString::fromUtf8(response.body)));
 			else
-				Logger::debug(QStringLiteral("HTTP ok: status %1, bytes %2").arg(response.statusCode).arg(response.body.size()));
+				Logger::debug(QStringLiteral("HTTP ok: status %1, bytes %2").arg(response.statusCode).arg(flight->onChunk ? flight->streamedBytes : response.body.size()));
 			
-			callback(Result<HttpResponse>::success(response));
+			result = Result<HttpResponse>::success(response);
+		}
+
+		const QList<InFlightWaiter> waiters = flight->waiters;
+		flight->waiters.clear();
+		for (const InFlightWaiter &w : waiters)
+		{
+			QObject::disconnect(w.cancelConnection);
+			if (w.timer)
+				w.timer->stop();
 		}
+		for (const InFlightWaiter &w : waiters)
+			w.callback(result);
 
 		reply->deleteLater();
+		pumpQueue(host);
+	});
+}
+
+// 主机维度的并发 key：host + port
+QString HttpClient::hostKey(const QUrl &url)
+{
+	return url.host().toLower() + QStringLiteral(":") + QString::number(url.port(url.scheme() == QStringLiteral("https") ? 443 : 80));
+}
+
+void HttpClient::enqueue(const QString &host, const QByteArray &method, const QByteArray &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk, int timeoutMs)
+{
+	QueuedRequest entry;
+	entry.seq = ++nextQueueSeq;
+	entry.method = method;
+	entry.key = key;
+	entry.options = options;
+	entry.token = token;
+	entry.callback = callback;
+	entry.onChunk = onChunk;
+	entry.timeoutMs = timeoutMs;
+	entry.enqueuedAt = QDateTime::currentMSecsSinceEpoch();
+
+	// 排队期间取消：直接出队并回调取消错误
+	if (token)
+	{
+		const quint64 seq = entry.seq;
+		entry.cancelConnection = QObject::connect(token.data(), &RequestToken::cancelled, this, [this, host, seq]() {
+			QList<QueuedRequest> &queue = queuedByHost[host];
+			for (int i = 0; i < queue.size(); ++i)
+			{
+				if (queue.at(i).seq != seq)
+					continue;
+				QueuedRequest removed = queue.takeAt(i);
+				QObject::disconnect(removed.cancelConnection);
+				if (queue.isEmpty())
+					queuedByHost.remove(host);
+				removed.callback(Result<HttpResponse>::failure(makeCancelledError()));
+				return;
+			}
+		});
+	}
+
+	QList<QueuedRequest> &queue = queuedByHost[host];
+	queue.append(entry);
+	queuedTotal++;
+	Logger::debug(QStringLiteral("HTTP queued %1 %2 (priority %3, depth %4)")
+					  .arg(QString::fromLatin1(method))
+					  .arg(options.url.path())
+					  .arg(static_cast<int>(effectivePriority(entry)))
+					  .arg(queue.size()));
+}
+
+// 按优先级（同优先级先进先出）取出请求，直到主机并发名额用完
+void HttpClient::pumpQueue(const QString &host)
+{
+	while (activeByHost.value(host) < maxConnectionsPerHost)
+	{
+		auto qit = queuedByHost.find(host);
+		if (qit == queuedByHost.end() || qit->isEmpty())
+		{
+			queuedByHost.remove(host);
+			return;
+		}
+		QList<QueuedRequest> &queue = qit.value();
+		int best = 0;
+		for (int i = 1; i < queue.size(); ++i)
+		{
+			if (effectivePriority(queue.at(i)) > effectivePriority(queue.at(best)))
+				best = i;
+		}
+		QueuedRequest entry = queue.takeAt(best);
+		const int depth = queue.size();
+		if (queue.isEmpty())
+			queuedByHost.remove(host);
+		QObject::disconnect(entry.cancelConnection);
+
+		const qint64 waitMs = QDateTime::currentMSecsSinceEpoch() - entry.enqueuedAt;
+		totalQueueWaitMs += waitMs;
+		maxQueueWaitMs = qMax(maxQueueWaitMs, waitMs);
+		Logger::debug(QStringLiteral("HTTP dequeued %1 (priority %2, waited %3 ms, depth %4)")
+						  .arg(entry.options.url.path())
+						  .arg(static_cast<int>(effectivePriority(entry)))
+						  .arg(waitMs)
+						  .arg(depth));
+
+		// 排队期间可能已有相同请求发出，直接合并；与 dispatch 一样按剩余截止时间收紧超时，已到期则直接失败
+		if (!entry.key.isEmpty())
+		{
+			auto it = inFlight.constFind(entry.key);
+			if (it != inFlight.constEnd())
+			{
+				if (!entry.options.deadline.isForever() && entry.options.deadline.hasExpired())
+				{
+					Error e;
+					e.category = ErrorCategory::Network;
+					e.code = static_cast<int>(QNetworkReply::TimeoutError);
+					e.message = QStringLiteral("Request timeout");
+					entry.callback(Result<HttpResponse>::failure(e));
+					continue;
+				}
+				int timeoutMs = entry.timeoutMs;
+				if (!entry.options.deadline.isForever())
+					timeoutMs = static_cast<int>(qBound<qint64>(1, entry.options.deadline.remainingTime(), timeoutMs));
+				attachWaiter(it.value(), entry.token, entry.callback, timeoutMs);
+				continue;
+			}
+		}
+		dispatch(host, entry.method, entry.key, entry.options, entry.token, entry.callback, entry.onChunk, entry.timeoutMs);
+	}
+}
+
+RequestPriority HttpClient::effectivePriority(const QueuedRequest &entry)
+{
+	if (entry.token && entry.token->hasPriority())
+		return entry.token->priority();
+	return entry.options.priority;
+}
+
+// 设置单个主机的最大并发请求数
+void HttpClient::setMaxConnectionsPerHost(int limit)
+{
+	maxConnectionsPerHost = qMax(1, limit);
+	const QStringList hosts = queuedByHost.keys();
+	for (const QString &host : hosts)
+		pumpQueue(host);
+}
+
+// 返回调度器统计快照
+HttpSchedulerStats HttpClient::schedulerStats() const
+{
+	HttpSchedulerStats stats;
+	for (auto it = activeByHost.cbegin(); it != activeByHost.cend(); ++it)
+		stats.activeRequests += it.value();
+	for (auto it = queuedByHost.cbegin(); it != queuedByHost.cend(); ++it)
+		stats.queuedRequests += it.value().size();
+	stats.dispatchedTotal = dispatchedTotal;
+	stats.queuedTotal = queuedTotal;
+	stats.averageQueueWaitMs = queuedTotal > 0 ? static_cast<double>(totalQueueWaitMs) / static_cast<double>(queuedTotal) : 0.0;
+	stats.maxQueueWaitMs = maxQueueWaitMs;
+	return stats;
+}
+
+// 延迟按 host + path 归类，忽略查询参数
+QString HttpClient::endpointKey(const QUrl &url)
+{
+	return url.host().toLower() + url.path();
+}
+
+void HttpClient::recordLatency(const QString &endpoint, qint64 elapsedMs)
+{
+	if (endpoint.isEmpty() || elapsedMs < 0)
+		return;
+	EndpointLatency &stats = latencyByEndpoint[endpoint];
+	const int sample = static_cast<int>(qMin<qint64>(elapsedMs, 10 * 60 * 1000));
+	stats.ewmaMs = stats.count == 0 ? sample : stats.ewmaMs + kLatencyEwmaAlpha * (sample - stats.ewmaMs);
+	++stats.count;
+	if (stats.samples.size() < kLatencyWindow)
+		stats.samples.append(sample);
+	else
+		stats.samples[stats.nextSample] = sample;
+	stats.nextSample = (stats.nextSample + 1) % kLatencyWindow;
+}
+
+// 超时取 p95 的 3 倍与 EWMA 的 4 倍中较大者，限制在 [3s, 调用方上限] 之间
+int HttpClient::adaptiveTimeoutFor(const QUrl &url, int fallbackMs) const
+{
+	auto it = latencyByEndpoint.constFind(endpointKey(url));
+	if (it == latencyByEndpoint.constEnd() || it->count < kMinLatencySamples)
+		return fallbackMs;
+	QList<int> sorted = it->samples;
+	const int p95Index = qMin(static_cast<int>(sorted.size() * 0.95), static_cast<int>(sorted.size()) - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + p95Index, sorted.end());
+	const qint64 p95 = sorted.at(p95Index);
+	const qint64 adaptive = qMax<qint64>(p95 * 3, static_cast<qint64>(it->ewmaMs * 4));
+	return static_cast<int>(qBound<qint64>(qMin(kMinAdaptiveTimeoutMs, fallbackMs), adaptive, fallbackMs));
+}
+
+int HttpClient::effectiveTimeout(const HttpRequestOptions &options) const
+{
+	const int limit = options.timeoutMs > 0 ? options.timeoutMs : 15000;
+	int timeoutMs = options.adaptiveTimeout ? adaptiveTimeoutFor(options.url, limit) : limit;
+	if (!options.deadline.isForever())
+		timeoutMs = static_cast<int>(qBound<qint64>(1, options.deadline.remainingTime(), timeoutMs));
+	return timeoutMs;
+}
+
+bool HttpClient::takeRetryToken()
+{
+	if (retryTokens < 1.0)
+		return false;
+	retryTokens -= 1.0;
+	return true;
+}
+
+// 规范化请求 key：timestamp 每次都不同，不能参与比较；cookie 参数与鉴权头保留以区分用户
+QByteArray HttpClient::requestKey(const QByteArray &method, const HttpRequestOptions &options, bool withAuth) const
+{
+	QUrl url = options.url.adjusted(QUrl::RemoveFragment);
+	if (url.hasQuery())
+	{
+		QUrlQuery query(url);
+		query.removeAllQueryItems(QStringLiteral("timestamp"));
+		if (!withAuth)
+			query.removeAllQueryItems(QStringLiteral("cookie"));
+		url.setQuery(query);
+	}
+
+	QMap<QByteArray, QByteArray> headers = defaultHeaders;
+	for (auto it = options.headers.cbegin(); it != options.headers.cend(); ++it)
+		headers.insert(it.key().toLower(), it.value());
+	if (!withAuth)
+	{
+		headers.remove("cookie");
+		headers.remove("authorization");
+	}
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(method);
+	hash.addData(QByteArrayView("\n"));
+	hash.addData(url.toEncoded());
+	hash.addData(QByteArrayView("\n"));
+	for (auto it = headers.cbegin(); it != headers.cend(); ++it)
+	{
+		hash.addData(it.key().toLower());
+		hash.addData(QByteArrayView(":"));
+		hash.addData(it.value());
+		hash.addData(QByteArrayView("\n"));
+	}
+	hash.addData(options.body);
+	return hash.result();
+}
+
+void HttpClient::attachWaiter(const QSharedPointer<InFlightRequest> &flight, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, int timeoutMs)
+{
+	InFlightWaiter waiter;
+	waiter.id = ++nextWaiterId;
+	waiter.callback = callback;
+	const quint64 waiterId = waiter.id;
+
+	// 启用请求级别的超时控制
+	waiter.timer = new QTimer(flight->reply);
+	waiter.timer->setSingleShot(true);
+	QObject::connect(waiter.timer, &QTimer::timeout, this, [this, flight, waiterId]() {
+		Error e;
+		e.category = ErrorCategory::Network;
+		e.code = static_cast<int>(QNetworkReply::TimeoutError);
+		e.message = QStringLiteral("Request timeout");
+		Logger::warning(QStringLiteral("HTTP timeout: %1").arg(flight->reply->url().path()));
+		// 超时说明端点至少这么慢，按两倍耗时记入样本，使后续超时随之放宽
+		if (!flight->onChunk && !flight->latencyRecorded)
+		{
+			flight->latencyRecorded = true;
+			recordLatency(flight->endpoint, (QDateTime::currentMSecsSinceEpoch() - flight->startedAt) * 2);
+		}
+		detachWaiter(flight, waiterId, e);
+	});
+	waiter.timer->start(timeoutMs);
+
+	// 将取消令牌与当前调用方绑定，取消只让该调用方离开
+	if (token)
+	{
+		waiter.cancelConnection = QObject::connect(token.data(), &RequestToken::cancelled, flight->reply, [this, flight, waiterId]() {
+			detachWaiter(flight, waiterId, makeCancelledError());
+		});
+	}
+
+	flight->waiters.append(waiter);
+}
+
+void HttpClient::detachWaiter(const QSharedPointer<InFlightRequest> &flight, quint64 waiterId, const Error &error)
+{
+	int index = -1;
+	for (int i = 0; i < flight->waiters.size(); ++i)
+	{
+		if (flight->waiters.at(i).id == waiterId)
+		{
+			index = i;
+			break;
+		}
+	}
+	if (index < 0)
+		return;
+
+	InFlightWaiter waiter = flight->waiters.takeAt(index);
+	QObject::disconnect(waiter.cancelConnection);
+	if (waiter.timer)
+		waiter.timer->stop();
+
+	// 最后一个调用方离开时从合并表移除并中止 reply，之后的相同请求会重新发起
+	if (flight->waiters.isEmpty())
+	{
+		if (!flight->key.isEmpty() && inFlight.value(flight->key) == flight)
+			inFlight.remove(flight->key);
+		if (flight->reply->isRunning())
+			flight->reply->abort();
+	}
+
+	waiter.callback(Result<HttpResponse>::failure(error));
+}
+
+// 缓存 key 去掉 cookie 后以作用域区分用户，cookie 刷新不会导致缓存全部失效
+void HttpClient::sendCached(const QByteArray &method, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback)
+{
+	const QString key = cacheScope + QStringLiteral("|") + QString::fromLatin1(requestKey(method, options, false).toHex());
+	lookupCache(key, options.cache.tag, [this, key, options, token, callback](bool hit, const CachedResponse &cached, qint64 tagTime) {
+		sendWithCacheEntry(key, options, token, callback, hit, cached, tagTime);
+	});
+}
+
+// 流式 GET 的缓存：可用的缓存条目整体作为一个数据块交付（过期时同样后台刷新），
+// 未命中时照常流式下载，同时累积 body，完成后写入缓存供普通请求与后续调用复用
+void HttpClient::sendStreamingCached(const QByteArray &method, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk)
+{
+	const QString key = cacheScope + QStringLiteral("|") + QString::fromLatin1(requestKey(method, options, false).toHex());
+	lookupCache(key, options.cache.tag, [this, key, options, token, callback, onChunk](bool hit, const CachedResponse &cached, qint64 tagTime) {
+		const bool invalidated = hit && tagTime > 0 && tagTime >= cached.storedAt;
+		if (hit && !invalidated && QDateTime::currentMSecsSinceEpoch() < cached.staleUntil)
+		{
+			sendWithCacheEntry(key, options, token, deliverAsSingleChunk(onChunk, callback), hit, cached, tagTime);
+			return;
+		}
+
+		HttpRequestOptions network = options;
+		network.cache.enabled = false;
+		const HttpCachePolicy policy = options.cache;
+		QSharedPointer<QByteArray> body = QSharedPointer<QByteArray>::create();
+		sendOnce(network, token, [this, key, policy, body, callback](Result<HttpResponse> result) {
+			if (result.ok && result.value.statusCode == 200 && !body->isEmpty())
+			{
+				Result<HttpResponse> full = result;
+				full.value.body = *body;
+				applyNetworkResult(key, policy, nullptr, full);
+			}
+			callback(result);
+		}, [body, onChunk](const QByteArray &chunk) {
+			body->append(chunk);
+			onChunk(chunk);
+		});
+	});
+}
+
+void HttpClient::sendWithCacheEntry(const QString &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, bool hit, const CachedResponse &cached, qint64 tagTime)
+{
+	const HttpCachePolicy policy = options.cache;
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	const bool invalidated = hit && tagTime > 0 && tagTime >= cached.storedAt;
+
+	// 新鲜命中或处于 stale-while-revalidate 窗口：异步回调，保证调用方先拿到取消令牌
+	if (hit && !invalidated && now < cached.staleUntil)
+	{
+		const bool fresh = now < cached.freshUntil;
+		const HttpResponse response = cached.response;
+		Logger::debug(QStringLiteral("HTTP cache %1: %2").arg(fresh ? QStringLiteral("hit") : QStringLiteral("stale")).arg(options.url.path()));
+		QTimer::singleShot(0, this, [token, callback, response]() {
+			if (token && token->isCancelled())
+			{
+				callback(Result<HttpResponse>::failure(makeCancelledError()));
+				return;
+			}
+			callback(Result<HttpResponse>::success(response));
+		});
+		if (fresh)
+			return;
+
+		// 后台刷新不绑定调用方的令牌，调用方取消不影响缓存更新
+		HttpRequestOptions refresh = options;
+		refresh.cache.enabled = false;
+		refresh.priority = RequestPriority::Prefetch;
+		if (policy.revalidate)
+		{
+			QByteArray etag = findHeader(cached.response.headers, "ETag");
+			QByteArray lastModified = findHeader(cached.response.headers, "Last-Modified");
+			if (!etag.isEmpty())
+				refresh.headers.insert("If-None-Match", etag);
+			if (!lastModified.isEmpty())
+				refresh.headers.insert("If-Modified-Since", lastModified);
+		}
+		sendOnce(refresh, QSharedPointer<RequestToken>(), [this, key, policy, cached](Result<HttpResponse> result) {
+			applyNetworkResult(key, policy, &cached, result);
+		});
+		return;
+	}
+
+	HttpRequestOptions network = options;
+	network.cache.enabled = false;
+	bool conditional = false;
+	if (hit && policy.revalidate)
+	{
+		QByteArray etag = findHeader(cached.response.headers, "ETag");
+		QByteArray lastModified = findHeader(cached.response.headers, "Last-Modified");
+		if (!etag.isEmpty())
+			network.headers.insert("If-None-Match", etag);
+		if (!lastModified.isEmpty())
+			network.headers.insert("If-Modified-Since", lastModified);
+		conditional = !etag.isEmpty() || !lastModified.isEmpty();
+	}
+	sendOnce(network, token, [this, key, policy, conditional, cached, callback](Result<HttpResponse> result) {
+		callback(applyNetworkResult(key, policy, conditional ? &cached : nullptr, result));
+	});
+}
+
+Result<HttpResponse> HttpClient::applyNetworkResult(const QString &key, const HttpCachePolicy &policy, const CachedResponse *cached, const Result<HttpResponse> &result)
+{
+	if (!result.ok)
+		return result;
+	const int status = result.value.statusCode;
+	if (status != 200 && !(status == 304 && cached))
+		return result;
+	if (status == 200 && policy.cacheIf && !policy.cacheIf(result.value))
+	{
+		Logger::debug(QStringLiteral("HTTP cache skipped by validator: %1").arg(key.right(12)));
+		return result;
+	}
+
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	CachedResponse entry;
+	if (status == 304)
+	{
+		Logger::debug(QStringLiteral("HTTP cache revalidated: %1").arg(key.right(12)));
+		entry.response = cached->response;
+	}
+	else
+	{
+		entry.response = result.value;
+	}
+	entry.storedAt = now;
+	entry.freshUntil = now + qMax(0, policy.ttlMs);
+	entry.staleUntil = entry.freshUntil + qMax(0, policy.staleWhileRevalidateMs);
+	storeCache(key, entry);
+	return Result<HttpResponse>::success(entry.response);
+}
+
+// 先查内存再查磁盘，磁盘命中后回填内存；内存命中且标签失效时间已知时同步回调，否则在磁盘 I/O 线程上读取后回调
+void HttpClient::lookupCache(const QString &key, const QString &tag, const CacheLookupCallback &callback)
+{
+	const QString scopedTag = tag.isEmpty() ? QString() : cacheScope + QStringLiteral("|") + tag;
+	auto tagIt = tagInvalidatedAt.constFind(scopedTag);
+	const bool tagKnown = scopedTag.isEmpty() || tagIt != tagInvalidatedAt.constEnd();
+	CachedResponse entry;
+	const bool memoryHit = memoryCache.get(key, entry);
+	if (memoryHit && tagKnown)
+	{
+		callback(true, entry, scopedTag.isEmpty() ? 0 : tagIt.value());
+		return;
+	}
+
+	struct DiskLookup
+	{
+		bool hit = false;
+		CachedResponse entry;
+		qint64 tagTime = 0;
+	};
+	const QString tagKey = tagKnown ? QString() : QStringLiteral("tag:") + scopedTag;
+	diskCache.run<DiskLookup>([key, tagKey, memoryHit](DiskCache &c) -> DiskLookup {
+		DiskLookup lookup;
+		QByteArray raw;
+		if (!memoryHit && c.get(key, raw))
+			lookup.hit = decodeCacheEntry(raw, lookup.entry);
+		if (!tagKey.isEmpty() && c.get(tagKey, raw))
+			lookup.tagTime = raw.toLongLong();
+		return lookup;
+	}, [this, key, scopedTag, tagKnown, memoryHit, entry, callback](DiskLookup lookup) {
+		// 读盘期间 invalidateCache 已写入的失效时间以内存为准
+		if (!tagKnown && !tagInvalidatedAt.contains(scopedTag))
+			tagInvalidatedAt.insert(scopedTag, lookup.tagTime);
+		const qint64 tagTime = scopedTag.isEmpty() ? 0 : tagInvalidatedAt.value(scopedTag);
+		if (memoryHit)
+		{
+			callback(true, entry, tagTime);
+			return;
+		}
+		if (lookup.hit)
+			memoryCache.set(key, lookup.entry);
+		callback(lookup.hit, lookup.entry, tagTime);
+	});
+}
+
+bool HttpClient::decodeCacheEntry(const QByteArray &raw, CachedResponse &out)
+{
+	QDataStream in(raw);
+	quint32 version = 0;
+	in >> version;
+	if (version != kCacheFormatVersion)
+		return false;
+	CachedResponse entry;
+	qint32 status = 0;
+	in >> entry.storedAt >> entry.freshUntil >> entry.staleUntil >> status >> entry.response.headers >> entry.response.body;
+	if (in.status() != QDataStream::Ok)
+		return false;
+	entry.response.statusCode = status;
+	out = entry;
+	return true;
+}
+
+void HttpClient::storeCache(const QString &key, const CachedResponse &entry)
+{
+	// 内存条目至少保留到 stale 窗口结束，过期后仍可用于条件请求
+	qint64 keepMs = qMax<qint64>(entry.staleUntil - entry.storedAt, 10 * 60 * 1000);
+	memoryCache.set(key, entry, static_cast<int>(qMin<qint64>(keepMs, 24LL * 60 * 60 * 1000)));
+
+	// 序列化与写盘都放到 I/O 线程
+	diskCache.post([key, entry](DiskCache &c) {
+		QByteArray raw;
+		QDataStream out(&raw, QIODevice::WriteOnly);
+		out << kCacheFormatVersion << entry.storedAt << entry.freshUntil << entry.staleUntil
+			<< static_cast<qint32>(entry.response.statusCode) << entry.response.headers << entry.response.body;
+		c.put(key, raw);
 	});
 }
 
@@ -2,19 +2,52 @@
 #pragma once
 
 #include <QByteArray>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QList>
 #include <QMap>
 #include <QNetworkAccessManager>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 #include <QUrl>
 
 #include <functional>
 
+class QNetworkReply;
+class QTimer;
+
 #include "core_types.h"
+#include "async_disk_cache.h"
+#include "memory_cache.h"
 
 namespace App
 {
 
+// 请求优先级：数值越大越先出队
+enum class RequestPriority
+{
+	// 推测性预取（下一页、下一首等）
+	Prefetch = 0,
+	// 当前可见的列表数据
+	VisibleData = 1,
+	// 当前歌曲的歌词、封面等
+	CurrentMedia = 2,
+	// 决定何时开始出声的播放请求
+	Playback = 3
+};
+
+// 调度器统计：用于观察排队深度与等待时间
+struct HttpSchedulerStats
+{
+	int activeRequests = 0;
+	int queuedRequests = 0;
+	qint64 dispatchedTotal = 0;
+	qint64 queuedTotal = 0;
+	double averageQueueWaitMs = 0.0;
+	qint64 maxQueueWaitMs = 0;
+};
+
 // 请求取消令牌，用于在 UI 层主动终止正在进行的请求
 class RequestToken : public QObject
 {
@@ -26,13 +59,46 @@ public:
 	void cancel();
 	// 查询当前请求是否已被取消
 	bool isCancelled() const;
+	// 调整优先级：仍在排队的请求按新优先级出队，用于用户操作后提升预取请求
+	void setPriority(RequestPriority priority);
+	RequestPriority priority() const;
+	// 是否显式设置过优先级；未设置时使用请求配置中的优先级
+	bool hasPriority() const;
 
 signals:
 	// 当请求被取消时发出，用于通知底层中止网络操作
 	void cancelled();
+	// 优先级变化时发出，组合令牌据此同步到下游请求
+	void priorityChanged(RequestPriority priority);
 
 private:
 	bool cancelledFlag = false;
+	bool prioritySet = false;
+	RequestPriority currentPriority = RequestPriority::VisibleData;
+};
+
+// HTTP 响应结果（状态码 + body + 响应头）
+struct HttpResponse
+{
+	int statusCode = 0;
+	QByteArray body;
+	QMap<QByteArray, QByteArray> headers;
+};
+
+// 响应缓存策略（默认关闭，仅对 GET 生效）
+struct HttpCachePolicy
+{
+	bool enabled = false;
+	// 新鲜期：期间直接返回缓存，不发起请求
+	int ttlMs = 0;
+	// 过期后该时间窗口内先返回旧数据，同时在后台刷新
+	int staleWhileRevalidateMs = 0;
+	// 缓存过期后携带 ETag / Last-Modified 发起条件请求，304 时复用缓存
+	bool revalidate = true;
+	// 失效标签：invalidateCache(tag) 之后，此前写入的同标签缓存不再直接使用
+	QString tag;
+	// 写入前的校验：返回 false 的 200 响应照常交给调用方，但不写入缓存（如 HTTP 200 中携带业务错误码）
+	std::function<bool(const HttpResponse &)> cacheIf;
 };
 
 // 单次 HTTP 请求配置
@@ -42,19 +108,37 @@ struct HttpRequestOptions
 	QByteArray method = "GET";
 	QMap<QByteArray, QByteArray> headers;
 	QByteArray body;
+	// 超时上限；端点积累足够延迟样本后按观测值自适应收紧，不会超过该值
 	int timeoutMs = 15000;
+	// 是否根据端点历史延迟自适应超时
+	bool adaptiveTimeout = true;
+	// 调用方的截止时间：到期后不再发起重试，单次请求超时也不会超过剩余时间
+	QDeadlineTimer deadline{QDeadlineTimer::Forever};
+	// 是否与正在进行中的相同 GET 请求合并，共享同一个 reply 与响应
+	bool coalesce = true;
+	// 响应缓存策略
+	HttpCachePolicy cache;
+	// 调度优先级，可被令牌上显式设置的优先级覆盖
+	RequestPriority priority = RequestPriority::VisibleData;
 };
 
-// HTTP 响应结果（状态码 + body + 响应头）
-struct HttpResponse
+// 作用域截止时间：作用域内（当前线程）发起的请求自动继承该截止时间，
+// 用于把上层调用的总截止时间传递给 Provider 内部发起的请求
+class HttpDeadlineScope
 {
-	int statusCode = 0;
-	QByteArray body;
-	QMap<QByteArray, QByteArray> headers;
+public:
+	explicit HttpDeadlineScope(const QDeadlineTimer &deadline);
+	~HttpDeadlineScope();
+	static QDeadlineTimer current();
+
+private:
+	QDeadlineTimer previous;
 };
 
 // 请求完成回调，统一使用 Result<HttpResponse> 表达成功或失败
 using HttpCallback = std::function<void(Result<HttpResponse>)>;
+// 流式数据回调：2xx 响应的 body 分块到达时按顺序回调
+using HttpChunkCallback = std::function<void(const QByteArray &)>;
 
 // HTTP 客户端，对 QNetworkAccessManager 进行高层封装
 class HttpClient : public QObject
@@ -70,11 +154,30 @@ public:
 	void setUserAgent(const QByteArray &ua);
 	// 控制是否自动跟随重定向
 	void setFollowRedirects(bool enabled);
+	// 设置缓存作用域（通常为当前登录用户 id），不同作用域的缓存互不可见
+	void setCacheScope(const QString &scope);
+	// 使指定标签下已写入的缓存失效，用于写操作之后避免读到旧数据
+	void invalidateCache(const QString &tag);
+	// 设置单个主机的最大并发请求数，超出的请求按优先级排队
+	void setMaxConnectionsPerHost(int limit);
+	// 获取调度器统计快照
+	HttpSchedulerStats schedulerStats() const;
+	// 获取端点（host + path）当前的自适应超时，样本不足时返回 fallbackMs
+	int adaptiveTimeoutFor(const QUrl &url, int fallbackMs) const;
+	// 设置需要预热的上游源（scheme + host + port），启动与网络切换后提前建立连接
+	void setWarmUpOrigins(const QList<QUrl> &origins);
+	// 立即对所有预热源发起 DNS / TCP / TLS 握手，HTTPS 源通过 ALPN 协商 HTTP/2
+	void warmUp();
 
 	// 发起单次请求，不带自动重试，返回取消令牌
 	QSharedPointer<RequestToken> send(const HttpRequestOptions &options, const HttpCallback &callback);
-	// 发起带重试与指数退避的请求，返回取消令牌
+	// 发起带重试与指数退避（full jitter）的请求，返回取消令牌
+	// 重试次数受全局重试预算限制，截止时间到期后不再重试
 	QSharedPointer<RequestToken> sendWithRetry(const HttpRequestOptions &options, int maxRetries, int baseDelayMs, const HttpCallback &callback);
+	// 发起流式请求：body 通过 onChunk 边到达边交付，完成回调中 2xx 响应的 body 为空
+	// 已交付部分数据后无法安全重放，因此不做重试。可挂到相同的普通请求上或命中缓存，此时整个 body 作为一个数据块交付；
+	// 启用缓存时下载完成的响应会写入缓存
+	QSharedPointer<RequestToken> sendStreaming(const HttpRequestOptions &options, const HttpChunkCallback &onChunk, const HttpCallback &callback);
 
 private:
 	// 底层网络访问管理器
@@ -86,12 +189,139 @@ private:
 	// 是否启用自动重定向
 	bool followRedirects = true;
 
+	// 共享同一个 reply 的调用方
+	struct InFlightWaiter
+	{
+		quint64 id = 0;
+		HttpCallback callback;
+		QTimer *timer = nullptr;
+		QMetaObject::Connection cancelConnection;
+	};
+	// 进行中的请求，key 为空表示不参与合并
+	struct InFlightRequest
+	{
+		QByteArray key;
+		QNetworkReply *reply = nullptr;
+		QList<InFlightWaiter> waiters;
+		// 流式请求的数据回调，为空表示整体缓冲
+		HttpChunkCallback onChunk;
+		qint64 streamedBytes = 0;
+		// 延迟统计使用的端点与发出时间
+		QString endpoint;
+		qint64 startedAt = 0;
+		bool latencyRecorded = false;
+		bool ttfbLogged = false;
+	};
+	// 可合并的进行中请求表：规范化请求 key -> 进行中的 reply
+	QHash<QByteArray, QSharedPointer<InFlightRequest>> inFlight;
+	quint64 nextWaiterId = 0;
+
+	// 等待连接名额的请求
+	struct QueuedRequest
+	{
+		quint64 seq = 0;
+		QByteArray method;
+		QByteArray key;
+		HttpRequestOptions options;
+		QSharedPointer<RequestToken> token;
+		HttpCallback callback;
+		HttpChunkCallback onChunk;
+		int timeoutMs = 0;
+		qint64 enqueuedAt = 0;
+		QMetaObject::Connection cancelConnection;
+	};
+	// 单个主机最大并发数，与 QNetworkAccessManager 的 HTTP/1.1 连接数一致
+	int maxConnectionsPerHost = 6;
+	QHash<QString, int> activeByHost;
+	QHash<QString, QList<QueuedRequest>> queuedByHost;
+	quint64 nextQueueSeq = 0;
+	qint64 dispatchedTotal = 0;
+	qint64 queuedTotal = 0;
+	qint64 totalQueueWaitMs = 0;
+	qint64 maxQueueWaitMs = 0;
+
+	// 缓存的响应及其新鲜度信息（绝对时间，毫秒）
+	struct CachedResponse
+	{
+		HttpResponse response;
+		qint64 storedAt = 0;
+		qint64 freshUntil = 0;
+		qint64 staleUntil = 0;
+	};
+	// 内存缓存按正文与响应头的字节数计费
+	static qint64 cachedResponseCost(const CachedResponse &cached);
+	// 一级缓存：内存，命中时无需读盘，另有字节预算
+	MemoryCache<CachedResponse> memoryCache;
+	// 二级缓存：磁盘，跨进程重启保留；读写在独立的 I/O 线程上执行
+	AsyncDiskCache diskCache;
+	QString cacheScope;
+	// 标签失效时间：作用域 + 标签 -> 失效时刻，未命中时从磁盘读取
+	QHash<QString, qint64> tagInvalidatedAt;
+
+	// 端点延迟统计：EWMA 反映近期水平，最近样本窗口用于估算 p95
+	struct EndpointLatency
+	{
+		double ewmaMs = 0.0;
+		int count = 0;
+		QList<int> samples;
+		int nextSample = 0;
+	};
+	QHash<QString, EndpointLatency> latencyByEndpoint;
+	// 全局重试预算（令牌桶）：每个完成的网络请求存入少量令牌，每次重试消耗一个
+	double retryTokens = 0.0;
+
+	// 连接预热：预热源、各主机最近一次使用时间，以及首个请求 TTFB 的记录
+	QList<QUrl> warmUpOriginList;
+	QHash<QString, qint64> lastUsedByHost;
+	QSet<QString> warmedHosts;
+	QSet<QString> ttfbLoggedHosts;
+	QTimer *keepWarmTimer = nullptr;
+	QTimer *networkChangeTimer = nullptr;
+
 	// 将默认头与调用方指定的头统一写入请求
 	void applyHeaders(QNetworkRequest &request, const HttpRequestOptions &options);
 	// 实际执行一次请求（不带重试），可被重试逻辑复用
-	void sendOnce(const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback);
+	void sendOnce(const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk = HttpChunkCallback());
+	// 发出请求并占用主机连接名额
+	void dispatch(const QString &host, const QByteArray &method, const QByteArray &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk, int timeoutMs);
+	// 主机并发已满时排队
+	void enqueue(const QString &host, const QByteArray &method, const QByteArray &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk, int timeoutMs);
+	// 有空闲名额时按优先级出队
+	void pumpQueue(const QString &host);
+	static QString hostKey(const QUrl &url);
+	static RequestPriority effectivePriority(const QueuedRequest &entry);
+	// 计算规范化请求 key：method + 去掉 timestamp 的 URL + 请求头 + body
+	// withAuth 为 false 时同时去掉 cookie 参数与鉴权头，由缓存作用域区分用户
+	QByteArray requestKey(const QByteArray &method, const HttpRequestOptions &options, bool withAuth = true) const;
+	// 带缓存策略的 GET：命中新鲜缓存直接返回，否则按策略条件请求或后台刷新
+	void sendCached(const QByteArray &method, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback);
+	// 带缓存策略的流式 GET：命中时整体交付，未命中时流式下载并在完成后写入缓存
+	void sendStreamingCached(const QByteArray &method, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, const HttpChunkCallback &onChunk);
+	// 将网络结果写入缓存；304 时返回缓存中的完整响应
+	Result<HttpResponse> applyNetworkResult(const QString &key, const HttpCachePolicy &policy, const CachedResponse *cached, const Result<HttpResponse> &result);
+	// 缓存查找结果：是否命中、缓存条目、标签失效时间
+	using CacheLookupCallback = std::function<void(bool hit, const CachedResponse &entry, qint64 tagTime)>;
+	void lookupCache(const QString &key, const QString &tag, const CacheLookupCallback &callback);
+	void sendWithCacheEntry(const QString &key, const HttpRequestOptions &options, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, bool hit, const CachedResponse &cached, qint64 tagTime);
+	static bool decodeCacheEntry(const QByteArray &raw, CachedResponse &out);
+	void storeCache(const QString &key, const CachedResponse &entry);
+	// 将调用方挂到进行中的请求上，取消与超时只影响该调用方
+	void attachWaiter(const QSharedPointer<InFlightRequest> &flight, const QSharedPointer<RequestToken> &token, const HttpCallback &callback, int timeoutMs);
+	// 移除单个调用方；当没有调用方时才真正中止 reply
+	void detachWaiter(const QSharedPointer<InFlightRequest> &flight, quint64 waiterId, const Error &error);
 	// 判断一次请求结果是否符合重试条件
 	bool isRetryable(const Result<HttpResponse> &result) const;
+	static QString endpointKey(const QUrl &url);
+	void warmUpOrigin(const QUrl &origin);
+	// 定时续热最近仍在使用的主机，避免空闲连接被回收后下一次请求重新握手
+	void keepWarm();
+	void recordLatency(const QString &endpoint, qint64 elapsedMs);
+	// 合并作用域截止时间，取较早者
+	static HttpRequestOptions withScopedDeadline(const HttpRequestOptions &options);
+	// 综合自适应超时与截止时间，计算本次请求实际使用的超时
+	int effectiveTimeout(const HttpRequestOptions &options) const;
+	// 尝试从重试预算中取出一个令牌，预算耗尽时返回 false
+	bool takeRetryToken();
 };
 
 }
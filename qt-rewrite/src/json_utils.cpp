@@ -1,6 +1,8 @@
 // JsonUtils 实现：统一 JSON 字段读取与错误构造
 #include "json_utils.h"
 
+#include <QJsonDocument>
+
 // 匿名命名空间内的辅助模板函数，仅在当前编译单元可见
 namespace
 {
@@ -161,5 +163,141 @@ Result<QJsonArray> readArray(const QJsonObject &obj, const QString &key, bool re
 	return typeError<QJsonArray>(key, QStringLiteral("array"));
 }
 
+ArrayObjectScanner::ArrayObjectScanner(const QString &arrayKey)
+	: key(arrayKey.toUtf8())
+{
+}
+
+// 逐字节维护字符串 / 嵌套深度状态；只有目标数组内的完整元素才交给 QJsonDocument 解析
+QList<QJsonObject> ArrayObjectScanner::feed(const QByteArray &chunk)
+{
+	QList<QJsonObject> out;
+	if (complete || chunk.isEmpty())
+		return out;
+
+	const int base = buffer.size();
+	buffer.append(chunk);
+	const char *data = buffer.constData();
+	const int size = buffer.size();
+	int restFrom = elementStart >= 0 ? -1 : base;
+
+	for (int i = base; i < size; ++i)
+	{
+		const char c = data[i];
+		if (inString)
+		{
+			if (escaped)
+				escaped = false;
+			else if (c == '\\')
+				escaped = true;
+			else if (c == '"')
+			{
+				inString = false;
+				if (stringStart >= 0)
+				{
+					lastString = partialString + QByteArray(data + stringStart, i - stringStart);
+					partialString.clear();
+					stringStart = -1;
+				}
+			}
+			continue;
+		}
+
+		switch (c)
+		{
+		case '"':
+			inString = true;
+			// 只记录根对象第一层的字符串，元素内部的字符串无需关心
+			stringStart = (depth == 1 && elementStart < 0) ? i + 1 : -1;
+			break;
+		case '{':
+		case '[':
+			if (arrayDepth >= 0 && depth == arrayDepth && elementStart < 0 && c == '{')
+			{
+				// 新元素开始：之前的数据归入 rest
+				if (restFrom >= 0)
+					rest.append(data + restFrom, i - restFrom);
+				restFrom = -1;
+				elementStart = i;
+			}
+			++depth;
+			if (c == '[' && depth == 2 && arrayDepth < 0 && !arrayDone && lastString == key)
+				arrayDepth = depth;
+			break;
+		case '}':
+		case ']':
+			--depth;
+			if (elementStart >= 0 && depth == arrayDepth)
+			{
+				QJsonParseError pe{};
+				QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromRawData(data + elementStart, i - elementStart + 1), &pe);
+				if (pe.error == QJsonParseError::NoError && doc.isObject())
+					out.append(doc.object());
+				elementStart = -1;
+				restFrom = i + 1;
+			}
+			else if (c == ']' && arrayDepth >= 0 && depth == arrayDepth - 1)
+			{
+				arrayDepth = -1;
+				arrayDone = true;
+			}
+			if (depth == 0)
+				complete = true;
+			break;
+		case ',':
+			// 数组元素之间的逗号不写入 rest，保证 skeleton 中目标数组为空数组
+			if (arrayDepth >= 0 && depth == arrayDepth && elementStart < 0)
+			{
+				if (restFrom >= 0)
+					rest.append(data + restFrom, i - restFrom);
+				restFrom = i + 1;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (elementStart >= 0)
+	{
+		// 保留未结束元素的数据，丢弃已处理部分
+		buffer.remove(0, elementStart);
+		elementStart = 0;
+	}
+	else
+	{
+		if (restFrom >= 0 && restFrom < size)
+			rest.append(data + restFrom, size - restFrom);
+		// 跨分块的 key 字符串先暂存，下次从新 buffer 开头继续
+		if (inString && stringStart >= 0)
+		{
+			partialString.append(data + stringStart, size - stringStart);
+			stringStart = 0;
+		}
+		buffer.clear();
+	}
+	return out;
+}
+
+bool ArrayObjectScanner::isComplete() const
+{
+	return complete;
+}
+
+Result<QJsonObject> ArrayObjectScanner::skeleton() const
+{
+	QJsonParseError pe{};
+	QJsonDocument doc = QJsonDocument::fromJson(rest, &pe);
+	if (!complete || pe.error != QJsonParseError::NoError || !doc.isObject())
+	{
+		Error e;
+		e.category = ErrorCategory::Parser;
+		e.code = -1;
+		e.message = QStringLiteral("Incomplete JSON response");
+		return Result<QJsonObject>::failure(e);
+	}
+	return Result<QJsonObject>::success(doc.object());
+}
+
 }
 }
@@ -4,6 +4,7 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QList>
 
 #include "core_types.h"
 
@@ -27,5 +28,40 @@ Result<QJsonObject> readObject(const QJsonObject &obj, const QString &key, bool
 // 读取数组字段
 Result<QJsonArray> readArray(const QJsonObject &obj, const QString &key, bool required = true);
 
+// 增量扫描器：在数据分块到达时，逐个取出根对象中指定数组字段里的对象元素
+// 用于大响应（如上千首歌的歌单）边接收边解析，无需等待完整 body
+class ArrayObjectScanner
+{
+public:
+	explicit ArrayObjectScanner(const QString &arrayKey);
+
+	// 追加一段数据，返回本次新完整的数组元素
+	QList<QJsonObject> feed(const QByteArray &chunk);
+	// 根对象是否已完整结束
+	bool isComplete() const;
+	// 去掉数组元素后的根对象（目标数组为空数组），用于读取 code / total 等其余字段
+	Result<QJsonObject> skeleton() const;
+
+private:
+	QByteArray key;
+	// 尚未处理完的数据（仅保留当前未结束元素的部分）
+	QByteArray buffer;
+	// 根对象中除目标数组元素外的数据
+	QByteArray rest;
+	int depth = 0;
+	bool inString = false;
+	bool escaped = false;
+	// 根对象第一层最近出现的字符串（作为 key 候选）
+	QByteArray lastString;
+	QByteArray partialString;
+	int stringStart = -1;
+	// 目标数组所在深度，-1 表示尚未进入
+	int arrayDepth = -1;
+	bool arrayDone = false;
+	// 当前元素在 buffer 中的起始位置，-1 表示不在元素内
+	int elementStart = -1;
+	bool complete = false;
+};
+
 }
 }
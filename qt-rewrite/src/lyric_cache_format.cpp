@@ -0,0 +1,351 @@
+// 歌词缓存二进制格式实现
+//
+// 布局（整数均为小端）：
+//   magic "LYRB" | version u8 | flags u8 | reserved u16 | lineCount u32 | wordCount u32 | textBytes u32
+//   lineCount 个 varint：时间戳与上一行的差值（zigzag 编码，首行相对 0）
+//   lineCount 组 varint：每行原文、翻译、音译的 UTF-8 字节长度
+//   lineCount 个 varint：每行的逐字时间个数，合计 wordCount
+//   wordCount 组 varint：相对行首的起始时间（zigzag）、时长、UTF-16 长度，按行顺序排列
+//   textBytes 字节的 UTF-8 文本，按行依次为原文、翻译、音译，首尾相接
+#include "lyric_cache_format.h"
+
+#include <QtEndian>
+
+#ifdef QT_DEBUG
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <functional>
+
+#include "logger.h"
+#endif
+
+#include <cstring>
+#include <utility>
+
+namespace App
+{
+namespace LyricCacheFormat
+{
+
+namespace
+{
+
+const char kMagic[4] = {'L', 'Y', 'R', 'B'};
+constexpr quint8 kVersion = 3;
+constexpr int kHeaderSize = 20;
+// 过滤后仍有有效歌词
+constexpr quint8 kFlagUsable = 0x01;
+
+void appendVarint(QByteArray &out, quint64 v)
+{
+	while (v >= 0x80)
+	{
+		out.append(static_cast<char>((v & 0x7F) | 0x80));
+		v >>= 7;
+	}
+	out.append(static_cast<char>(v));
+}
+
+bool readVarint(const uchar *&p, const uchar *end, quint64 &v)
+{
+	v = 0;
+	for (int shift = 0; shift < 64 && p < end; shift += 7)
+	{
+		const uchar b = *p++;
+		v |= static_cast<quint64>(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+	return false;
+}
+
+quint64 zigzag(qint64 v)
+{
+	return (static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63);
+}
+
+qint64 unzigzag(quint64 v)
+{
+	return static_cast<qint64>(v >> 1) ^ -static_cast<qint64>(v & 1);
+}
+
+bool isMetaLine(const QString &text)
+{
+	const QString t = text.trimmed();
+	return t.contains(QStringLiteral("\u4f5c\u8bcd")) || t.contains(QStringLiteral("\u4f5c\u66f2")) || t.contains(QStringLiteral("\u7f16\u66f2")) || t.startsWith(QStringLiteral("\u8bcd\uff1a")) || t.startsWith(QStringLiteral("\u66f2\uff1a")) || t.contains(QStringLiteral("\u5236\u4f5c\u4eba"));
+}
+
+}
+
+QByteArray encode(const Lyric &lyric)
+{
+	// 过滤 JSON 残留行；只剩作词作曲等信息行时视为无效，只记录标记
+	QList<const LyricLine *> kept;
+	kept.reserve(lyric.lines.size());
+	bool metaOnly = true;
+	for (const LyricLine &ll : lyric.lines)
+	{
+		const QString trimmed = ll.text.trimmed();
+		if (trimmed.startsWith(QLatin1Char('{')) || trimmed.startsWith(QLatin1Char('[')))
+			continue;
+		kept.append(&ll);
+		if (metaOnly && !isMetaLine(ll.text))
+			metaOnly = false;
+	}
+	const bool usable = !kept.isEmpty() && !metaOnly;
+	if (!usable)
+		kept.clear();
+
+	QByteArray times;
+	QByteArray lengths;
+	QByteArray wordCounts;
+	QByteArray words;
+	QByteArray text;
+	qint64 prev = 0;
+	quint32 wordCount = 0;
+	for (const LyricLine *ll : std::as_const(kept))
+	{
+		appendVarint(times, zigzag(ll->timeMs - prev));
+		prev = ll->timeMs;
+		for (const QString *part : {&ll->text, &ll->translation, &ll->romanization})
+		{
+			const QByteArray utf8 = part->toUtf8();
+			appendVarint(lengths, static_cast<quint64>(utf8.size()));
+			text.append(utf8);
+		}
+		const int begin = ll->wordBegin;
+		const int count = (ll->wordCount > 0 && begin >= 0 && begin + ll->wordCount <= lyric.words.size()) ? ll->wordCount : 0;
+		appendVarint(wordCounts, static_cast<quint64>(count));
+		for (int i = begin; i < begin + count; ++i)
+		{
+			const LyricWord &w = lyric.words.at(i);
+			appendVarint(words, zigzag(w.offsetMs));
+			appendVarint(words, static_cast<quint64>(qMax(0, w.durationMs)));
+			appendVarint(words, static_cast<quint64>(qMax(0, w.length)));
+		}
+		wordCount += static_cast<quint32>(count);
+	}
+
+	QByteArray out;
+	out.reserve(kHeaderSize + times.size() + lengths.size() + wordCounts.size() + words.size() + text.size());
+	out.append(kMagic, 4);
+	out.append(static_cast<char>(kVersion));
+	out.append(static_cast<char>(usable ? kFlagUsable : 0));
+	out.append(2, '\0');
+	char buf[4];
+	qToLittleEndian<quint32>(static_cast<quint32>(kept.size()), buf);
+	out.append(buf, 4);
+	qToLittleEndian<quint32>(wordCount, buf);
+	out.append(buf, 4);
+	qToLittleEndian<quint32>(static_cast<quint32>(text.size()), buf);
+	out.append(buf, 4);
+	out.append(times);
+	out.append(lengths);
+	out.append(wordCounts);
+	out.append(words);
+	out.append(text);
+	return out;
+}
+
+bool decode(const uchar *data, qint64 size, Lyric &outLyric)
+{
+	if (!data || size < kHeaderSize || memcmp(data, kMagic, 4) != 0 || data[4] != kVersion)
+		return false;
+	if (!(data[5] & kFlagUsable))
+		return false;
+	const quint32 count = qFromLittleEndian<quint32>(data + 8);
+	const quint32 wordCount = qFromLittleEndian<quint32>(data + 12);
+	const quint32 textBytes = qFromLittleEndian<quint32>(data + 16);
+	const uchar *end = data + size;
+	if (textBytes > static_cast<quint64>(size - kHeaderSize) || count == 0)
+		return false;
+	const uchar *textBase = end - textBytes;
+	const uchar *p = data + kHeaderSize;
+	// 每行至少占五个 varint 字节、每个字至少占三个，先校验个数再分配
+	if (static_cast<quint64>(count) * 5 + static_cast<quint64>(wordCount) * 3 > static_cast<quint64>(textBase - p))
+		return false;
+
+	Lyric lyric;
+	lyric.lines.resize(count);
+	qint64 t = 0;
+	for (quint32 i = 0; i < count; ++i)
+	{
+		quint64 v = 0;
+		if (!readVarint(p, textBase, v))
+			return false;
+		t += unzigzag(v);
+		lyric.lines[i].timeMs = t;
+	}
+	quint64 offset = 0;
+	for (quint32 i = 0; i < count; ++i)
+	{
+		LyricLine &line = lyric.lines[i];
+		for (QString *part : {&line.text, &line.translation, &line.romanization})
+		{
+			quint64 len = 0;
+			if (!readVarint(p, textBase, len) || offset + len > textBytes)
+				return false;
+			if (len > 0)
+				*part = QString::fromUtf8(reinterpret_cast<const char *>(textBase + offset), static_cast<qsizetype>(len));
+			offset += len;
+		}
+	}
+	quint64 wordsSeen = 0;
+	for (quint32 i = 0; i < count; ++i)
+	{
+		quint64 n = 0;
+		if (!readVarint(p, textBase, n) || wordsSeen + n > wordCount)
+			return false;
+		LyricLine &line = lyric.lines[i];
+		line.wordBegin = n > 0 ? static_cast<qint32>(wordsSeen) : 0;
+		line.wordCount = static_cast<qint32>(n);
+		wordsSeen += n;
+	}
+	if (wordsSeen != wordCount)
+		return false;
+	lyric.words.resize(wordCount);
+	for (quint32 i = 0; i < wordCount; ++i)
+	{
+		quint64 offsetMs = 0;
+		quint64 durationMs = 0;
+		quint64 length = 0;
+		if (!readVarint(p, textBase, offsetMs) || !readVarint(p, textBase, durationMs) || !readVarint(p, textBase, length))
+			return false;
+		LyricWord &w = lyric.words[i];
+		w.offsetMs = static_cast<qint32>(unzigzag(offsetMs));
+		w.durationMs = static_cast<qint32>(durationMs);
+		w.length = static_cast<qint32>(length);
+	}
+	if (p != textBase || offset != textBytes)
+		return false;
+	outLyric = std::move(lyric);
+	return true;
+}
+
+#ifdef QT_DEBUG
+namespace
+{
+
+// 旧格式的读取路径：JSON DOM 解析，每次读取都重新过滤
+bool decodeLegacyJson(const QByteArray &bytes, Lyric &outLyric)
+{
+	QJsonParseError err{};
+	QJsonDocument doc = QJsonDocument::fromJson(bytes, &err);
+	if (err.error != QJsonParseError::NoError || !doc.isObject())
+		return false;
+	QJsonArray arr = doc.object().value(QStringLiteral("lines")).toArray();
+	Lyric lyric;
+	lyric.lines.reserve(arr.size());
+	bool metaOnly = true;
+	for (const QJsonValue &v : arr)
+	{
+		QJsonObject o = v.toObject();
+		LyricLine ll;
+		ll.timeMs = static_cast<qint64>(o.value(QStringLiteral("t")).toDouble());
+		ll.text = o.value(QStringLiteral("x")).toString();
+		QString trimmed = ll.text.trimmed();
+		if (trimmed.startsWith(QLatin1Char('{')) || trimmed.startsWith(QLatin1Char('[')))
+			continue;
+		if (metaOnly && !isMetaLine(ll.text))
+			metaOnly = false;
+		lyric.lines.append(ll);
+	}
+	if (lyric.lines.isEmpty() || metaOnly)
+		return false;
+	outLyric = lyric;
+	return true;
+}
+
+QByteArray encodeLegacyJson(const Lyric &lyric)
+{
+	QJsonArray arr;
+	for (const LyricLine &ll : lyric.lines)
+	{
+		QJsonObject o;
+		o.insert(QStringLiteral("t"), static_cast<double>(ll.timeMs));
+		o.insert(QStringLiteral("x"), ll.text);
+		arr.append(o);
+	}
+	QJsonObject root;
+	root.insert(QStringLiteral("lines"), arr);
+	return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+}
+
+void runLoadBenchmark()
+{
+	constexpr int iterations = 2000;
+	constexpr int lineCount = 80;
+	Lyric lyric;
+	lyric.lines.append(LyricLine{0, QStringLiteral("\u4f5c\u8bcd : Bench")});
+	lyric.lines.append(LyricLine{1000, QStringLiteral("\u4f5c\u66f2 : Bench")});
+	for (int i = 0; i < lineCount; ++i)
+		lyric.lines.append(LyricLine{2000 + i * 3500LL, QStringLiteral("\u7b2c %1 \u884c\u6b4c\u8bcd Benchmark lyric line").arg(i)});
+
+	QTemporaryDir dir;
+	if (!dir.isValid())
+		return;
+	auto writeFile = [&dir](const QString &name, const QByteArray &data) {
+		QFile f(dir.filePath(name));
+		if (f.open(QIODevice::WriteOnly))
+			f.write(data);
+		return f.fileName();
+	};
+	const QByteArray json = encodeLegacyJson(lyric);
+	const QByteArray binary = encode(lyric);
+	const QString jsonPath = writeFile(QStringLiteral("lyric.json"), json);
+	const QString binaryPath = writeFile(QStringLiteral("lyric.bin"), binary);
+
+	// 解码失败只计数并写入日志，不中断程序
+	int failures = 0;
+	auto measure = [&failures](const std::function<bool()> &load) {
+		int loaded = 0;
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < iterations; ++i)
+		{
+			if (load())
+				++loaded;
+		}
+		const qint64 elapsed = timer.nsecsElapsed();
+		failures += iterations - loaded;
+		return static_cast<double>(elapsed) / iterations;
+	};
+	const double jsonNs = measure([&jsonPath]() {
+		QFile f(jsonPath);
+		if (!f.open(QIODevice::ReadOnly))
+			return false;
+		Lyric out;
+		return decodeLegacyJson(f.readAll(), out);
+	});
+	const double binaryNs = measure([&binaryPath]() {
+		QFile f(binaryPath);
+		if (!f.open(QIODevice::ReadOnly))
+			return false;
+		const qint64 size = f.size();
+		uchar *data = f.map(0, size);
+		if (!data)
+			return false;
+		Lyric out;
+		const bool ok = decode(data, size, out);
+		f.unmap(data);
+		return ok;
+	});
+	Logger::info(QStringLiteral("Lyric load bench: %1 lines, json %2 ns/load (%3 bytes), binary %4 ns/load (%5 bytes), failures %6")
+					 .arg(lyric.lines.size())
+					 .arg(jsonNs, 0, 'f', 0)
+					 .arg(json.size())
+					 .arg(binaryNs, 0, 'f', 0)
+					 .arg(binary.size())
+					 .arg(failures));
+}
+#endif
+
+}
+}
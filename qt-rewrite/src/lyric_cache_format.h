@@ -0,0 +1,24 @@
+// 歌词缓存的二进制格式：写入时完成过滤，读取时直接从映射内存解码
+#pragma once
+
+#include <QByteArray>
+
+#include "core_types.h"
+
+namespace App
+{
+namespace LyricCacheFormat
+{
+
+// 编码歌词：过滤 JSON 残留行，并记录是否只剩作词作曲等信息行（此时不保存歌词内容）
+QByteArray encode(const Lyric &lyric);
+// 解码歌词；格式或版本不符、数据截断，以及写入时判定为无效的歌词均返回 false
+bool decode(const uchar *data, qint64 size, Lyric &outLyric);
+
+#ifdef QT_DEBUG
+// 基准测试：对比旧 JSON 格式与二进制格式的单次歌词加载耗时（打开文件 + 解析 + 过滤）
+void runLoadBenchmark();
+#endif
+
+}
+}
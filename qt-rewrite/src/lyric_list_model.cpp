@@ -1,5 +1,11 @@
 #include "lyric_list_model.h"
 
+#ifdef QT_DEBUG
+#include <QElapsedTimer>
+
+#include "logger.h"
+#endif
+
 namespace App
 {
 
@@ -26,6 +32,12 @@ QVariant LyricListModel::data(const QModelIndex &index, int role) const
 		return static_cast<qint64>(line.timeMs);
 	case TextRole:
 		return line.text;
+	case WordTimedRole:
+		return line.wordCount > 0;
+	case TranslationRole:
+		return line.translation;
+	case RomanizationRole:
+		return line.romanization;
 	default:
 		return {};
 	}
@@ -36,6 +48,9 @@ QHash<int, QByteArray> LyricListModel::roleNames() const
 	QHash<int, QByteArray> roles;
 	roles[TimeMsRole] = "timeMs";
 	roles[TextRole] = "text";
+	roles[WordTimedRole] = "wordTimed";
+	roles[TranslationRole] = "translation";
+	roles[RomanizationRole] = "romanization";
 	return roles;
 }
 
@@ -43,6 +58,16 @@ void LyricListModel::setLyric(const Lyric &lyric)
 {
 	beginResetModel();
 	m_lyric = lyric;
+	m_hasTiming = false;
+	for (const LyricLine &l : m_lyric.lines)
+	{
+		if (l.timeMs > 0)
+		{
+			m_hasTiming = true;
+			break;
+		}
+	}
+	m_cursor = -1;
 	endResetModel();
 }
 
@@ -51,5 +76,179 @@ const Lyric &LyricListModel::lyric() const
 	return m_lyric;
 }
 
+bool LyricListModel::hasTiming() const
+{
+	return m_hasTiming;
 }
 
+int LyricListModel::advanceCursor(qint64 posMs)
+{
+	const int count = m_lyric.lines.size();
+	if (count == 0)
+		return -1;
+	if (!m_hasTiming)
+		return 0;
+	if (m_cursor < 0 || m_cursor >= count || (m_cursor > 0 && posMs < m_lyric.lines.at(m_cursor).timeMs))
+	{
+		m_cursor = findLine(posMs);
+		return m_cursor;
+	}
+	while (m_cursor + 1 < count && m_lyric.lines.at(m_cursor + 1).timeMs <= posMs)
+		++m_cursor;
+	return m_cursor;
+}
+
+void LyricListModel::invalidateCursor()
+{
+	m_cursor = -1;
+}
+
+// 最后一个时间不晚于 posMs 的行；posMs 早于首行时返回 0
+int LyricListModel::findLine(qint64 posMs) const
+{
+	int lo = 0;
+	int hi = m_lyric.lines.size() - 1;
+	int best = 0;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (m_lyric.lines.at(mid).timeMs <= posMs)
+		{
+			best = mid;
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	return best;
+}
+
+qreal LyricListModel::highlightProgress(int row, qint64 posMs, qint64 lineEndMs) const
+{
+	if (!m_hasTiming || row < 0 || row >= m_lyric.lines.size())
+		return 0;
+	const LyricLine &line = m_lyric.lines.at(row);
+	const qint64 rel = posMs - line.timeMs;
+	if (rel <= 0)
+		return 0;
+	const int total = line.text.size();
+	if (line.wordCount <= 0 || total <= 0 || line.wordBegin + line.wordCount > m_lyric.words.size())
+	{
+		const qint64 dur = qMax<qint64>(1, lineEndMs - line.timeMs);
+		return qBound<qreal>(0, static_cast<qreal>(rel) / dur, 1);
+	}
+	// 第一个字之前的文本（若有）随行一起高亮
+	const LyricWord *w = m_lyric.words.constData() + line.wordBegin;
+	int wordChars = 0;
+	for (int i = 0; i < line.wordCount; ++i)
+		wordChars += w[i].length;
+	qreal done = qMax(0, total - wordChars);
+	for (int i = 0; i < line.wordCount; ++i)
+	{
+		if (rel < w[i].offsetMs)
+			break;
+		if (rel >= static_cast<qint64>(w[i].offsetMs) + w[i].durationMs)
+		{
+			done += w[i].length;
+			continue;
+		}
+		done += w[i].length * static_cast<qreal>(rel - w[i].offsetMs) / qMax(1, w[i].durationMs);
+		break;
+	}
+	return qBound<qreal>(0, done / total, 1);
+}
+
+#ifdef QT_DEBUG
+namespace
+{
+
+// 旧实现：每次进度更新先全量扫描时间戳，再对整个列表二分查找
+int legacyLineIndex(const QList<LyricLine> &lines, qint64 posMs)
+{
+	if (lines.isEmpty())
+		return -1;
+	bool anyTimestamp = false;
+	for (const LyricLine &l : lines)
+	{
+		if (l.timeMs > 0)
+		{
+			anyTimestamp = true;
+			break;
+		}
+	}
+	if (!anyTimestamp)
+		return 0;
+	int lo = 0;
+	int hi = lines.size() - 1;
+	int best = 0;
+	while (lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (lines.at(mid).timeMs <= posMs)
+		{
+			best = mid;
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	return best;
+}
+
+}
+
+void LyricListModel::runCursorBenchmark()
+{
+	// 长逐字歌词：开头若干行时间为 0 的信息行，之后每行 10 个字
+	constexpr int lineCount = 3000;
+	constexpr qint64 tickMs = 50;
+	Lyric lyric;
+	for (int i = 0; i < 8; ++i)
+		lyric.lines.append(LyricLine{0, QStringLiteral("Credit %1").arg(i)});
+	for (int i = 0; i < lineCount; ++i)
+	{
+		LyricLine line{5000 + i * 2500LL, QStringLiteral("Benchmark lyric line %1").arg(i)};
+		line.wordBegin = lyric.words.size();
+		line.wordCount = 10;
+		for (int w = 0; w < 10; ++w)
+			lyric.words.append(LyricWord{w * 240, 230, 2});
+		lyric.lines.append(line);
+	}
+	const qint64 endMs = lyric.lines.last().timeMs + 5000;
+	const int ticks = static_cast<int>(endMs / tickMs);
+
+	LyricListModel model;
+	model.setLyric(lyric);
+	int mismatches = 0;
+	qint64 checksum = 0;
+	QElapsedTimer timer;
+	timer.start();
+	for (qint64 pos = 0; pos < endMs; pos += tickMs)
+		checksum += legacyLineIndex(model.lyric().lines, pos);
+	const qint64 legacyNs = timer.nsecsElapsed();
+	timer.restart();
+	for (qint64 pos = 0; pos < endMs; pos += tickMs)
+		checksum -= model.advanceCursor(pos);
+	const qint64 cursorNs = timer.nsecsElapsed();
+	// 校验游标与旧实现一致（包括跳转后的二分查找）
+	model.invalidateCursor();
+	for (qint64 pos = 0; pos < endMs; pos += tickMs * 7)
+	{
+		if (model.advanceCursor(pos) != legacyLineIndex(model.lyric().lines, pos))
+			++mismatches;
+	}
+	Logger::info(QStringLiteral("Lyric cursor bench: %1 lines, %2 ticks, full scan %3 ns/tick, cursor %4 ns/tick, mismatches %5, checksum %6")
+					 .arg(model.lyric().lines.size())
+					 .arg(ticks)
+					 .arg(static_cast<double>(legacyNs) / ticks, 0, 'f', 1)
+					 .arg(static_cast<double>(cursorNs) / ticks, 0, 'f', 1)
+					 .arg(mismatches)
+					 .arg(checksum));
+}
+#endif
+
+}
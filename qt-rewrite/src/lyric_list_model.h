@@ -15,7 +15,12 @@ public:
 	enum Roles
 	{
 		TimeMsRole = Qt::UserRole + 1,
-		TextRole
+		TextRole,
+		// 本行是否带逐字时间
+		WordTimedRole,
+		// 翻译与音译，没有时为空字符串
+		TranslationRole,
+		RomanizationRole
 	};
 
 	explicit LyricListModel(QObject *parent = nullptr);
@@ -27,8 +32,29 @@ public:
 	void setLyric(const Lyric &lyric);
 	const Lyric &lyric() const;
 
+	// 行内高亮进度（0~1，按文本长度计）：有逐字时间时逐字插值，否则在行首与 lineEndMs 之间线性插值
+	// 歌词没有时间戳时恒为 0；QML 在动画帧内按外推的播放位置调用
+	Q_INVOKABLE qreal highlightProgress(int row, qint64 posMs, qint64 lineEndMs) const;
+
+	// 是否有任意一行带时间戳；设置歌词时计算一次
+	bool hasTiming() const;
+	// 当前行游标：正常播放时与下一行时间比较向前推进（均摊 O(1)），
+	// 游标失效或时间倒退时改用二分查找。返回当前行，没有歌词时返回 -1
+	int advanceCursor(qint64 posMs);
+	// 跳转或调整歌词偏移后调用，下次定位改用二分查找
+	void invalidateCursor();
+
+#ifdef QT_DEBUG
+	// 基准测试：长逐字歌词下，每次进度更新的旧式全量扫描与游标推进耗时
+	static void runCursorBenchmark();
+#endif
+
 private:
 	Lyric m_lyric;
+	bool m_hasTiming = false;
+	int m_cursor = -1;
+
+	int findLine(qint64 posMs) const;
 };
 
 }
@@ -0,0 +1,410 @@
+// 歌词分词器实现：直接在 UTF-16 缓冲区上逐字符推进，除输出的行文本外不分配内存
+#include "lyric_parser.h"
+
+#include <algorithm>
+
+#ifdef QT_DEBUG
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <functional>
+
+#include "logger.h"
+#endif
+
+namespace App
+{
+namespace LyricParser
+{
+
+namespace
+{
+
+bool isAsciiDigit(QChar c)
+{
+	return c.unicode() >= u'0' && c.unicode() <= u'9';
+}
+
+// 读取连续数字，返回位数；超过 18 位的部分不再累加，避免溢出
+int readDigits(const QChar *p, qsizetype n, qsizetype &i, qint64 &value)
+{
+	value = 0;
+	int digits = 0;
+	while (i < n && isAsciiDigit(p[i]))
+	{
+		if (digits < 18)
+			value = value * 10 + (p[i].unicode() - u'0');
+		++digits;
+		++i;
+	}
+	return digits;
+}
+
+void skipSpaces(const QChar *p, qsizetype n, qsizetype &i)
+{
+	while (i < n && p[i].isSpace())
+		++i;
+}
+
+bool expect(const QChar *p, qsizetype n, qsizetype &i, char16_t c)
+{
+	if (i >= n || p[i].unicode() != c)
+		return false;
+	++i;
+	return true;
+}
+
+// 小数部分按位数换算为毫秒：.5 -> 500，.05 -> 50，多于 3 位时截断
+qint64 fractionToMs(qint64 value, int digits)
+{
+	if (digits == 1)
+		return value * 100;
+	if (digits == 2)
+		return value * 10;
+	while (digits > 3)
+	{
+		value /= 10;
+		--digits;
+	}
+	return value;
+}
+
+// 读取 (start,dur,flag) 时间块，成功时 i 移到块后
+bool readWordChunk(const QChar *p, qsizetype n, qsizetype &i, qint64 &startMs, qint64 &durationMs)
+{
+	qsizetype j = i;
+	qint64 flag = 0;
+	if (!expect(p, n, j, u'(') || readDigits(p, n, j, startMs) == 0)
+		return false;
+	skipSpaces(p, n, j);
+	if (!expect(p, n, j, u','))
+		return false;
+	skipSpaces(p, n, j);
+	if (readDigits(p, n, j, durationMs) == 0)
+		return false;
+	skipSpaces(p, n, j);
+	if (!expect(p, n, j, u','))
+		return false;
+	skipSpaces(p, n, j);
+	if (readDigits(p, n, j, flag) == 0 || !expect(p, n, j, u')'))
+		return false;
+	i = j;
+	return true;
+}
+
+}
+
+bool readHead(QStringView line, LineHead &head)
+{
+	head.times.clear();
+	head.yrc = false;
+	head.yrcDurationMs = 0;
+	const QChar *p = line.data();
+	const qsizetype n = line.size();
+	qsizetype i = 0;
+	skipSpaces(p, n, i);
+	while (i < n && p[i].unicode() == u'[')
+	{
+		qsizetype j = i + 1;
+		qint64 first = 0;
+		if (readDigits(p, n, j, first) == 0)
+			break;
+		if (j < n && p[j].unicode() == u':')
+		{
+			// [mm:ss] / [mm:ss.x] / [mm:ss.xx] / [mm:ss.xxx]
+			++j;
+			qint64 seconds = 0;
+			if (readDigits(p, n, j, seconds) == 0)
+				break;
+			qint64 millis = 0;
+			if (j < n && p[j].unicode() == u'.')
+			{
+				++j;
+				qint64 fraction = 0;
+				const int digits = readDigits(p, n, j, fraction);
+				if (digits == 0)
+					break;
+				millis = fractionToMs(fraction, digits);
+			}
+			if (!expect(p, n, j, u']'))
+				break;
+			head.times.append(first * 60000 + seconds * 1000 + millis);
+			i = j;
+			continue;
+		}
+		// [start,dur]：yrc 行头只出现一次，且不与 LRC 标签混用
+		if (!head.times.isEmpty())
+			break;
+		skipSpaces(p, n, j);
+		if (!expect(p, n, j, u','))
+			break;
+		skipSpaces(p, n, j);
+		qint64 duration = 0;
+		if (readDigits(p, n, j, duration) == 0)
+			break;
+		skipSpaces(p, n, j);
+		if (!expect(p, n, j, u']'))
+			break;
+		head.times.append(first);
+		head.yrc = true;
+		head.yrcDurationMs = duration;
+		i = j;
+		break;
+	}
+	head.textStart = i;
+	return !head.times.isEmpty();
+}
+
+bool appendTimedLine(QStringView line, Lyric &lyric)
+{
+	LineHead head;
+	if (!readHead(line, head))
+		return false;
+	const QChar *p = line.data();
+	const qsizetype n = line.size();
+	const qint64 lineTimeMs = head.times.first();
+	const qsizetype wordBegin = lyric.words.size();
+
+	// 时间块 (start,dur,0) 位于对应文字之前：文字归入前一个时间块，首个时间块之前的文字单独计数
+	QString text;
+	text.reserve(n - head.textStart);
+	qsizetype prefixLen = 0;
+	qsizetype segmentStart = head.textStart;
+	auto flushText = [&](qsizetype end) {
+		const qsizetype len = end - segmentStart;
+		if (len <= 0)
+			return;
+		text.append(p + segmentStart, len);
+		if (lyric.words.size() > wordBegin)
+			lyric.words.last().length += static_cast<qint32>(len);
+		else
+			prefixLen += len;
+	};
+	qsizetype i = head.textStart;
+	while (i < n)
+	{
+		if (p[i].unicode() != u'(')
+		{
+			++i;
+			continue;
+		}
+		qsizetype j = i;
+		qint64 startMs = 0;
+		qint64 durationMs = 0;
+		if (!readWordChunk(p, n, j, startMs, durationMs))
+		{
+			++i;
+			continue;
+		}
+		flushText(i);
+		// LRC 行中的时间块只去掉，不作为逐字时间
+		if (head.yrc)
+		{
+			LyricWord w;
+			w.offsetMs = static_cast<qint32>(startMs - lineTimeMs);
+			w.durationMs = static_cast<qint32>(durationMs);
+			lyric.words.append(w);
+		}
+		i = j;
+		segmentStart = j;
+	}
+	flushText(n);
+
+	// 去掉首尾空白，同步扣减首尾几个字的长度
+	qsizetype lead = 0;
+	while (lead < text.size() && text.at(lead).isSpace())
+		++lead;
+	if (lead == text.size())
+	{
+		lyric.words.resize(wordBegin);
+		return true;
+	}
+	qsizetype trail = 0;
+	while (text.at(text.size() - 1 - trail).isSpace())
+		++trail;
+	qsizetype cut = qMax<qsizetype>(0, lead - prefixLen);
+	for (qsizetype k = wordBegin; k < lyric.words.size() && cut > 0; ++k)
+	{
+		const qint32 m = static_cast<qint32>(qMin<qsizetype>(cut, lyric.words[k].length));
+		lyric.words[k].length -= m;
+		cut -= m;
+	}
+	cut = trail;
+	for (qsizetype k = lyric.words.size() - 1; k >= wordBegin && cut > 0; --k)
+	{
+		const qint32 m = static_cast<qint32>(qMin<qsizetype>(cut, lyric.words[k].length));
+		lyric.words[k].length -= m;
+		cut -= m;
+	}
+	text.chop(trail);
+	text.remove(0, lead);
+
+	LyricLine ll;
+	ll.text = text;
+	ll.wordCount = static_cast<qint32>(lyric.words.size() - wordBegin);
+	ll.wordBegin = ll.wordCount > 0 ? static_cast<qint32>(wordBegin) : 0;
+	for (qint64 t : head.times)
+	{
+		ll.timeMs = t;
+		lyric.lines.append(ll);
+	}
+	return true;
+}
+
+void attachSecondary(Lyric &lyric, QStringView text, QString LyricLine::*field, qint64 toleranceMs)
+{
+	if (lyric.lines.isEmpty() || text.trimmed().isEmpty())
+		return;
+	Lyric secondary;
+	forEachLine(text, [&secondary](QStringView line) {
+		appendTimedLine(line, secondary);
+	});
+	if (secondary.lines.isEmpty())
+		return;
+	std::stable_sort(secondary.lines.begin(), secondary.lines.end(), [](const LyricLine &a, const LyricLine &b) {
+		return a.timeMs < b.timeMs;
+	});
+
+	const QList<LyricLine> &sec = secondary.lines;
+	const qsizetype m = sec.size();
+	qsizetype j = 0;
+	for (LyricLine &line : lyric.lines)
+	{
+		const qint64 t = line.timeMs;
+		// 跳过早于容差范围、无法再匹配的行
+		while (j < m && sec.at(j).timeMs < t - toleranceMs)
+			++j;
+		if (j >= m)
+			break;
+		// 容差范围内可能有多行，取时间最接近的一行
+		while (j + 1 < m && qAbs(sec.at(j + 1).timeMs - t) < qAbs(sec.at(j).timeMs - t))
+			++j;
+		if (qAbs(sec.at(j).timeMs - t) > toleranceMs)
+			continue;
+		// 网易云用 "//" 占位表示该行没有翻译
+		if (sec.at(j).text != QLatin1String("//"))
+			line.*field = sec.at(j).text;
+		++j;
+	}
+}
+
+#ifdef QT_DEBUG
+namespace
+{
+
+// 旧实现：统一换行后拆分为 QStringList，每行依次尝试 yrc 行头、LRC 行头与时间块三个正则
+int parseLegacy(const QString &text, Lyric &lyric)
+{
+	QString normalized = text;
+	normalized.replace("\r\n", "\n");
+	normalized.replace("\r", "\n");
+	const QStringList lines = normalized.split('\n');
+	QRegularExpression yrcHead(QStringLiteral("^\\[(\\d+)\\s*,\\s*(\\d+)\\]"));
+	QRegularExpression lrcHead(QStringLiteral("^\\[(\\d{1,2}):(\\d{2})(?:\\.(\\d{1,3}))?\\]"));
+	QRegularExpression chunk(QStringLiteral("\\([0-9]+\\s*,\\s*[0-9]+\\s*,\\s*[0-9]+\\)"));
+	for (const QString &line : lines)
+	{
+		QString l = line;
+		qint64 t = 0;
+		bool matched = false;
+		QRegularExpressionMatch hm = yrcHead.match(l);
+		if (hm.hasMatch())
+		{
+			t = hm.captured(1).toLongLong();
+			l.remove(yrcHead);
+			matched = true;
+		}
+		if (!matched)
+		{
+			QRegularExpressionMatch lm = lrcHead.match(l);
+			if (lm.hasMatch())
+			{
+				const QString msPart = lm.captured(3);
+				const int rawMs = msPart.toInt();
+				const int millis = msPart.size() == 1 ? rawMs * 100 : (msPart.size() == 2 ? rawMs * 10 : rawMs);
+				t = lm.captured(1).toInt() * 60000LL + lm.captured(2).toInt() * 1000LL + millis;
+				l.remove(lrcHead);
+				matched = true;
+			}
+		}
+		if (!matched)
+			continue;
+		l.remove(chunk);
+		const QString trimmed = l.trimmed();
+		if (trimmed.isEmpty())
+			continue;
+		LyricLine ll;
+		ll.timeMs = t;
+		ll.text = trimmed;
+		lyric.lines.append(ll);
+	}
+	return lyric.lines.size();
+}
+
+QString buildCorpus()
+{
+	QString corpus;
+	// yrc：每行 8 个逐字时间块
+	for (int i = 0; i < 60; ++i)
+	{
+		const qint64 start = 10000 + i * 4000LL;
+		corpus += QStringLiteral("[%1,3800]").arg(start);
+		for (int w = 0; w < 8; ++w)
+			corpus += QStringLiteral("(%1,450,0)\u5b57%2 ").arg(start + w * 475).arg(w);
+		corpus += QStringLiteral("\r\n");
+	}
+	// LRC：普通行与带多个标签的副歌行
+	for (int i = 0; i < 60; ++i)
+	{
+		const int m = i / 20;
+		const int s = (i * 3) % 60;
+		corpus += QStringLiteral("[%1:%2.%3]Benchmark lyric line %4 \u6b4c\u8bcd\n")
+					  .arg(m, 2, 10, QLatin1Char('0'))
+					  .arg(s, 2, 10, QLatin1Char('0'))
+					  .arg(i % 100, 2, 10, QLatin1Char('0'))
+					  .arg(i);
+	}
+	corpus += QStringLiteral("[01:10.00][02:20.50]Chorus line\n");
+	return corpus;
+}
+
+}
+
+void runBenchmark()
+{
+	constexpr int iterations = 500;
+	const QString corpus = buildCorpus();
+
+	auto measure = [&corpus](const std::function<int(const QString &)> &parse, int &lines) {
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < iterations; ++i)
+			lines = parse(corpus);
+		return static_cast<double>(timer.nsecsElapsed()) / iterations;
+	};
+	int legacyLines = 0;
+	int tokenizerLines = 0;
+	const double legacyNs = measure([](const QString &text) {
+		Lyric lyric;
+		return parseLegacy(text, lyric);
+	}, legacyLines);
+	const double tokenizerNs = measure([](const QString &text) {
+		Lyric lyric;
+		forEachLine(text, [&lyric](QStringView line) {
+			appendTimedLine(line, lyric);
+		});
+		return static_cast<int>(lyric.lines.size());
+	}, tokenizerLines);
+	Logger::info(QStringLiteral("Lyric parse bench: %1 chars, regex %2 ns/parse (%3 lines), tokenizer %4 ns/parse (%5 lines), %6x")
+					 .arg(corpus.size())
+					 .arg(legacyNs, 0, 'f', 0)
+					 .arg(legacyLines)
+					 .arg(tokenizerNs, 0, 'f', 0)
+					 .arg(tokenizerLines)
+					 .arg(tokenizerNs > 0 ? legacyNs / tokenizerNs : 0.0, 0, 'f', 1));
+}
+#endif
+
+}
+}
@@ -0,0 +1,64 @@
+// 歌词分词器：单遍扫描 UTF-16 文本，识别 [mm:ss.xx] 标签（一行可有多个）、[start,dur] yrc 行头与 (start,dur,flag) 逐字时间块
+#pragma once
+
+#include <QStringView>
+#include <QVarLengthArray>
+
+#include "core_types.h"
+
+namespace App
+{
+namespace LyricParser
+{
+
+// 行首的时间标签
+struct LineHead
+{
+	// 各标签的时间；yrc 行头只有一个，即该行的开始时间
+	QVarLengthArray<qint64, 4> times;
+	// 是否为 [start,dur] 形式的 yrc 行头
+	bool yrc = false;
+	qint64 yrcDurationMs = 0;
+	// 正文在行内的起点
+	qsizetype textStart = 0;
+};
+
+// 逐行遍历文本，兼容 \n、\r\n 与 \r 换行，不复制文本
+template <typename Fn>
+void forEachLine(QStringView text, Fn &&fn)
+{
+	const QChar *p = text.data();
+	const qsizetype n = text.size();
+	qsizetype start = 0;
+	for (qsizetype i = 0; i < n; ++i)
+	{
+		const char16_t c = p[i].unicode();
+		if (c != u'\n' && c != u'\r')
+			continue;
+		fn(text.mid(start, i - start));
+		if (c == u'\r' && i + 1 < n && p[i + 1].unicode() == u'\n')
+			++i;
+		start = i + 1;
+	}
+	if (start < n)
+		fn(text.mid(start));
+}
+
+// 读取行首（允许前导空白）连续的时间标签；[ar:xx] 等信息标签会结束读取。没有任何时间标签时返回 false
+bool readHead(QStringView line, LineHead &head);
+
+// 解析一行带时间标签的歌词并追加到 lyric：yrc 行的时间块转为逐字时间，LRC 行去掉时间块，多个标签各生成一行
+// 正文为空的行不追加；行首没有时间标签时返回 false
+bool appendTimedLine(QStringView line, Lyric &lyric);
+
+// 把翻译或音译（LRC 文本）并入原文各行的 field 字段：两边按时间排序后双指针线性配对，
+// 时间差在 toleranceMs 以内的取最近的一行；lyric.lines 需已按时间排序
+void attachSecondary(Lyric &lyric, QStringView text, QString LyricLine::*field, qint64 toleranceMs);
+
+#ifdef QT_DEBUG
+// 基准测试：对比旧的正则逐行解析与分词器在同一份歌词语料上的耗时
+void runBenchmark();
+#endif
+
+}
+}
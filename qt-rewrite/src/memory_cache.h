@@ -1,99 +1,158 @@
-// 通用内存缓存模板，带 TTL 过期与容量控制
+// 通用内存缓存模板，带 TTL 过期、LRU 淘汰与容量控制
 #pragma once
 
 #include <QDateTime>
 #include <QHash>
 #include <QString>
 
+#include <functional>
+#include <iterator>
+#include <list>
+#include <utility>
+
 namespace App
 {
 
+// 缓存统计：用于观察命中率与淘汰情况
+struct MemoryCacheStats
+{
+	qint64 hits = 0;
+	qint64 misses = 0;
+	qint64 evictions = 0;
+	int entries = 0;
+	qint64 bytes = 0;
+	qint64 maxBytes = 0;
+};
+
 template <typename T>
 class MemoryCache
 {
 public:
-	// 构造函数，指定最大条目数与默认过期时间（毫秒）
-	explicit MemoryCache(int maxEntries = 256, int defaultTtlMs = 30000)
+	// 估算单个值占用的字节数
+	using CostFunction = std::function<qint64(const T &)>;
+
+	// 构造函数，指定最大条目数与默认过期时间（毫秒）；maxBytes > 0 且提供 cost 时同时按字节预算淘汰
+	explicit MemoryCache(int maxEntries = 256, int defaultTtlMs = 30000, qint64 maxBytes = 0, CostFunction cost = CostFunction())
 		: maxSize(maxEntries)
 		, defaultTtl(defaultTtlMs)
+		, maxCost(maxBytes)
+		, costOf(std::move(cost))
 	{
 	}
 
-	// 写入缓存条目，ttlMs <= 0 时使用默认 TTL
+	// 写入缓存条目，ttlMs <= 0 时使用默认 TTL；超出条目数或字节预算时从最久未用的一端淘汰
 	void set(const QString &key, const T &value, int ttlMs = -1)
 	{
 		qint64 now = QDateTime::currentMSecsSinceEpoch();
-		qint64 expire = now + static_cast<qint64>(ttlMs > 0 ? ttlMs : defaultTtl);
 		Entry entry;
+		entry.key = key;
 		entry.value = value;
-		entry.expireAt = expire;
-		entries.insert(key, entry);
-		// 若超出容量，优先清理过期条目
-		if (entries.size() > maxSize)
-			evictExpired();
-		// 若仍然超出容量，简单移除一条（近似 LRU，可按需扩展）
-		if (entries.size() > maxSize)
+		entry.expireAt = now + static_cast<qint64>(ttlMs > 0 ? ttlMs : defaultTtl);
+		entry.cost = costOf ? qMax<qint64>(0, costOf(value)) : 0;
+		// 单个值超过整个预算时不缓存，避免清空其余条目
+		if (maxCost > 0 && entry.cost > maxCost)
+		{
+			remove(key);
+			return;
+		}
+		auto it = index.find(key);
+		if (it != index.end())
+		{
+			totalCost -= it.value()->cost;
+			order.erase(it.value());
+			index.erase(it);
+		}
+		order.push_front(std::move(entry));
+		index.insert(key, order.begin());
+		totalCost += order.front().cost;
+		while (!order.empty() && (static_cast<int>(index.size()) > maxSize || (maxCost > 0 && totalCost > maxCost)))
 		{
-			auto it = entries.begin();
-			if (it != entries.end())
-				entries.erase(it);
+			eraseNode(std::prev(order.end()));
+			++evictionCount;
 		}
 	}
 
-	// 读取缓存条目，如过期或不存在返回 false
+	// 读取缓存条目，如过期或不存在返回 false；命中时移到最近使用的一端
 	bool get(const QString &key, T &out)
 	{
-		qint64 now = QDateTime::currentMSecsSinceEpoch();
-		auto it = entries.find(key);
-		if (it == entries.end())
+		auto it = index.find(key);
+		if (it == index.end())
+		{
+			++missCount;
 			return false;
-		if (it->expireAt < now)
+		}
+		auto node = it.value();
+		if (node->expireAt < QDateTime::currentMSecsSinceEpoch())
 		{
-			entries.erase(it);
+			eraseNode(node);
+			++missCount;
 			return false;
 		}
-		out = it->value;
+		order.splice(order.begin(), order, node);
+		out = node->value;
+		++hitCount;
 		return true;
 	}
 
 	// 移除指定 key 的缓存
 	void remove(const QString &key)
 	{
-		entries.remove(key);
+		auto it = index.find(key);
+		if (it != index.end())
+			eraseNode(it.value());
 	}
 
-	// 清空所有缓存
+	// 清空所有缓存，统计计数保留
 	void clear()
 	{
-		entries.clear();
+		index.clear();
+		order.clear();
+		totalCost = 0;
+	}
+
+	MemoryCacheStats stats() const
+	{
+		MemoryCacheStats s;
+		s.hits = hitCount;
+		s.misses = missCount;
+		s.evictions = evictionCount;
+		s.entries = static_cast<int>(index.size());
+		s.bytes = totalCost;
+		s.maxBytes = maxCost;
+		return s;
 	}
 
 private:
-	// 缓存内部条目结构
+	// 缓存内部条目结构；链表头部为最近使用，尾部为最久未用
 	struct Entry
 	{
+		QString key;
 		T value;
 		qint64 expireAt = 0;
+		qint64 cost = 0;
 	};
+	using Node = typename std::list<Entry>::iterator;
 
-	// 实际存储结构：key -> 条目
-	QHash<QString, Entry> entries;
+	std::list<Entry> order;
+	// key -> 链表节点，查找、移动与删除均为 O(1)
+	QHash<QString, Node> index;
 	// 最大条目数
 	int maxSize;
 	// 默认过期时间（毫秒）
 	int defaultTtl;
+	// 字节预算，<= 0 表示只按条目数限制
+	qint64 maxCost;
+	CostFunction costOf;
+	qint64 totalCost = 0;
+	qint64 hitCount = 0;
+	qint64 missCount = 0;
+	qint64 evictionCount = 0;
 
-	// 清理已过期的缓存条目
-	void evictExpired()
+	void eraseNode(Node node)
 	{
-		qint64 now = QDateTime::currentMSecsSinceEpoch();
-		for (auto it = entries.begin(); it != entries.end();) 
-		{
-			if (it->expireAt < now)
-				it = entries.erase(it);
-			else
-				++it;
-		}
+		totalCost -= node->cost;
+		index.remove(node->key);
+		order.erase(node);
 	}
 };
 
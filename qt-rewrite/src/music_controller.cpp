@@ -2,6 +2,7 @@
 #include "music_controller.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QGuiApplication>
 #include <QClipboard>
 #include <QAudioOutput>
@@ -23,12 +24,18 @@
 #include <QTcpServer>
 #include <QThread>
 #include <QTimer>
+#include <QUrlQuery>
 #include <QBuffer>
 #include <QImage>
 #include <QImageReader>
 #include <QImageWriter>
 
+#include "cover_url.h"
 #include "logger.h"
+#include "lyric_cache_format.h"
+#include "lyric_parser.h"
+
+#include <utility>
 
 namespace App
 {
@@ -324,6 +331,102 @@ QUrl resolveLocalMusicApiBaseUrl()
 	return QUrl(QStringLiteral("http://127.0.0.1:%1").arg(port));
 }
 
+// 当前音质设置，与 NeteaseProvider 请求播放地址时使用的 level 一致
+QString readQualityLevel()
+{
+	QSettings settings;
+	settings.beginGroup(QStringLiteral("set"));
+	QString level = settings.value(QStringLiteral("musicQuality"), QStringLiteral("standard")).toString().trimmed();
+	settings.endGroup();
+	if (level.isEmpty())
+		level = QStringLiteral("standard");
+	return level;
+}
+
+// 播放地址接口使用的歌曲 id：GD Studio 需要带上实际来源
+QString playbackSongId(const Song &song)
+{
+	if (song.providerId == QStringLiteral("gdstudio"))
+		return song.source + QStringLiteral(":") + song.id;
+	return song.id;
+}
+
+// 播放地址的候选来源：GD Studio 默认按网易云 id 解析，可作为网易云歌曲的备用来源参与对冲
+QStringList playUrlProvidersFor(const QString &providerId)
+{
+	QStringList providers;
+	providers << providerId;
+	if (providerId == QStringLiteral("netease"))
+		providers << QStringLiteral("gdstudio");
+	return providers;
+}
+
+// 歌词目前只有网易云来源，其他来源返回空
+QString lyricProviderFor(const Song &song)
+{
+	if (song.providerId == QStringLiteral("netease") || song.source == QStringLiteral("netease"))
+		return QStringLiteral("netease");
+	return QString();
+}
+
+qint64 readAudioCacheMaxBytes()
+{
+	QSettings settings;
+	settings.beginGroup(QStringLiteral("set"));
+	qint64 mb = settings.value(QStringLiteral("audioCacheMaxMB"), 1024).toLongLong();
+	settings.endGroup();
+	return qMax<qint64>(0, mb) * 1024 * 1024;
+}
+
+QStringList coverExts()
+{
+	return {QStringLiteral("png"), QStringLiteral("jpg"), QStringLiteral("jpeg"), QStringLiteral("gif"), QStringLiteral("bmp")};
+}
+
+// 按文件头识别图片格式写入缓存；未知格式先解码再转存为 PNG，解码失败返回空
+QUrl writeCoverImage(DiskCache &cache, const QString &key, const QByteArray &data)
+{
+	auto sniffExt = [](const QByteArray &data) -> QString {
+		if (data.size() >= 8)
+		{
+			const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+			if (p[0] == 0x89 && p[1] == 0x50 && p[2] == 0x4E && p[3] == 0x47 && p[4] == 0x0D && p[5] == 0x0A && p[6] == 0x1A && p[7] == 0x0A)
+				return QStringLiteral("png");
+		}
+		if (data.size() >= 3)
+		{
+			const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+			if (p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF)
+				return QStringLiteral("jpg");
+		}
+		if (data.size() >= 6 && (QByteArray(data.constData(), 6) == QByteArray("GIF87a") || QByteArray(data.constData(), 6) == QByteArray("GIF89a")))
+			return QStringLiteral("gif");
+		if (data.size() >= 2 && QByteArray(data.constData(), 2) == QByteArray("BM"))
+			return QStringLiteral("bmp");
+		return QString();
+	};
+	QString ext = sniffExt(data);
+	if (ext.isEmpty())
+	{
+		QBuffer buf;
+		buf.setData(data);
+		buf.open(QIODevice::ReadOnly);
+		QImageReader reader(&buf);
+		QImage img = reader.read();
+		if (img.isNull())
+			return QUrl();
+		QBuffer out;
+		out.open(QIODevice::WriteOnly);
+		QImageWriter w(&out, "PNG");
+		if (!w.write(img))
+			return QUrl();
+		cache.putWithExt(key, out.data(), QStringLiteral("png"));
+		return cache.fileUrlForKeyExt(key, QStringLiteral("png"));
+	}
+	cache.putWithExt(key, data, ext);
+	return cache.fileUrlForKeyExt(key, ext);
+}
+
 }
 
 MusicController::MusicController(QObject *parent)
@@ -337,6 +440,7 @@ MusicController::MusicController(QObject *parent)
 	, m_player(this)
 	, imageCache(QStringLiteral("images"), 200LL * 1024 * 1024)
 	, lyricCache(QStringLiteral("lyrics"), 20LL * 1024 * 1024)
+	, audioCache(&httpClient, readAudioCacheMaxBytes(), this)
 {
 	QMap<QByteArray, QByteArray> headers;
 	headers.insert("Accept", "application/json");
@@ -352,11 +456,31 @@ MusicController::MusicController(QObject *parent)
 	int ncmPortSetting = settings.value(QStringLiteral("musicApiPort"), 30490).toInt();
 	int qqPort = settings.value(QStringLiteral("qqMusicApiPort"), 3200).toInt();
 	int playbackMode = settings.value(QStringLiteral("playbackMode"), static_cast<int>(Sequence)).toInt();
+	int prefetchAtPercent = settings.value(QStringLiteral("prefetchAtPercent"), 70).toInt();
+	int prefetchBeforeEndSec = settings.value(QStringLiteral("prefetchBeforeEndSec"), 20).toInt();
+	int prefetchAudioMB = settings.value(QStringLiteral("prefetchAudioMB"), 4).toInt();
+	int maxConnectionsPerHost = settings.value(QStringLiteral("maxConnectionsPerHost"), 6).toInt();
 	settings.endGroup();
+	httpClient.setMaxConnectionsPerHost(maxConnectionsPerHost);
+	m_prefetchAtRatio = qBound(0, prefetchAtPercent, 100) / 100.0;
+	m_prefetchBeforeEndMs = qMax(0, prefetchBeforeEndSec) * 1000LL;
+	m_prefetchAudioBytes = qMax(0, prefetchAudioMB) * 1024LL * 1024;
 	if (playbackMode < static_cast<int>(Sequence) || playbackMode > static_cast<int>(LoopOne))
 		playbackMode = static_cast<int>(Sequence);
 	m_playbackMode = playbackMode;
 
+#ifdef QT_DEBUG
+	// 设置 APP_SELFTEST_LYRIC_BENCH 时在事件循环启动后运行一次歌词加载基准测试
+	if (qEnvironmentVariableIsSet("APP_SELFTEST_LYRIC_BENCH"))
+		QTimer::singleShot(0, this, []() { LyricCacheFormat::runLoadBenchmark(); });
+	// 设置 APP_SELFTEST_LYRIC_PARSE_BENCH 时运行一次歌词解析基准测试（正则逐行解析 vs 分词器）
+	if (qEnvironmentVariableIsSet("APP_SELFTEST_LYRIC_PARSE_BENCH"))
+		QTimer::singleShot(0, this, []() { LyricParser::runBenchmark(); });
+	// 设置 APP_SELFTEST_LYRIC_CURSOR_BENCH 时运行一次歌词游标基准测试（每次进度更新的耗时）
+	if (qEnvironmentVariableIsSet("APP_SELFTEST_LYRIC_CURSOR_BENCH"))
+		QTimer::singleShot(0, this, []() { LyricListModel::runCursorBenchmark(); });
+#endif
+
 	bool explicitBaseUrl = !apiBaseStr.isEmpty();
 	QUrl apiBase = explicitBaseUrl ? QUrl(apiBaseStr) : resolveLocalMusicApiBaseUrl();
 	if (!apiBase.isValid())
@@ -403,6 +527,15 @@ MusicController::MusicController(QObject *parent)
 		}
 	}
 
+	// 解灰 worker 常驻复用，开启解灰时提前启动以隐藏 node 冷启动耗时
+	unblockWorker = new UnblockWorker(findEmbeddedMusicApiDir(apiDirOverride), this);
+	neteaseProvider->setUnblockWorker(unblockWorker);
+	settings.beginGroup(QStringLiteral("set"));
+	bool unblockEnabled = settings.value(QStringLiteral("enableMusicUnblock"), true).toBool();
+	settings.endGroup();
+	if (unblockEnabled)
+		unblockWorker->start();
+
 	gdStudioProvider = new GdStudioProvider(&httpClient, &providerManager);
 	providerManager.registerProvider(neteaseProvider);
 	providerManager.registerProvider(qqMusicProvider);
@@ -410,12 +543,35 @@ MusicController::MusicController(QObject *parent)
 	ProviderManagerConfig cfg;
 	cfg.providerOrder = QStringList() << neteaseProvider->id() << gdStudioProvider->id();
 	cfg.fallbackEnabled = true;
+	// 主来源卡顿时并行尝试备用来源，限制起播与搜索的长尾延迟
+	cfg.hedgingEnabled = true;
 	providerManager.setConfig(cfg);
 
+	// 提前与各来源建立连接，首个搜索 / 封面请求不再承担 DNS + TCP + TLS 握手
+	QList<QUrl> warmUpOrigins;
+	for (IProvider *provider : providerManager.providers())
+		warmUpOrigins.append(provider->warmUpOrigins());
+	httpClient.setWarmUpOrigins(warmUpOrigins);
+	httpClient.warmUp();
+
 	settings.beginGroup(QStringLiteral("auth"));
 	QString cookie = settings.value(QStringLiteral("cookie")).toString();
 	QString cookieQQ = settings.value(QStringLiteral("cookieQQ")).toString();
+	QString lastUserId = settings.value(QStringLiteral("userId")).toString();
 	settings.endGroup();
+	// HTTP 缓存按用户隔离：启动时沿用上次登录的用户，资料刷新后再切换
+	httpClient.setCacheScope(cookie.isEmpty() ? QString() : lastUserId);
+	providerManager.setCacheScope(cookie.isEmpty() ? QString() : lastUserId);
+	connect(this, &MusicController::userProfileChanged, this, [this]() {
+		httpClient.setCacheScope(m_userProfile.userId);
+		providerManager.setCacheScope(m_userProfile.userId);
+		if (m_userProfile.userId.isEmpty())
+			return;
+		QSettings settings;
+		settings.beginGroup(QStringLiteral("auth"));
+		settings.setValue(QStringLiteral("userId"), m_userProfile.userId);
+		settings.endGroup();
+	});
 	if (!cookie.isEmpty())
 	{
 		neteaseProvider->setCookie(cookie);
@@ -433,8 +589,16 @@ MusicController::MusicController(QObject *parent)
 	settings.endGroup();
 	m_player.audioOutput()->setVolume(savedVolume / 100.0);
 
+	// positionMs 只随时钟的同步点通知，播放中不再每次位置上报都触发 QML 绑定
+	QObject::connect(&m_clock, &PlaybackClock::synced, this, &MusicController::positionMsChanged);
 	QObject::connect(&m_player, &QMediaPlayer::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
 		setPlaying(state == QMediaPlayer::PlayingState);
+		m_clock.sync(m_player.position(), state == QMediaPlayer::PlayingState ? m_player.playbackRate() : 0);
+		if (state == QMediaPlayer::StoppedState)
+			Logger::debug(QStringLiteral("Playback clock: %1 position ticks, %2 sync points").arg(m_clock.tickCount()).arg(m_clock.syncCount()));
+	});
+	QObject::connect(&m_player, &QMediaPlayer::playbackRateChanged, this, [this](qreal rate) {
+		m_clock.sync(m_player.position(), m_player.playbackState() == QMediaPlayer::PlayingState ? rate : 0);
 	});
 	QObject::connect(&m_player, &QMediaPlayer::mediaStatusChanged, this, [this](QMediaPlayer::MediaStatus status) {
 		if (status == QMediaPlayer::EndOfMedia)
@@ -442,19 +606,37 @@ MusicController::MusicController(QObject *parent)
 	});
 	QObject::connect(&m_player, &QMediaPlayer::positionChanged, this, [this](qint64 pos) {
 		m_positionMs = pos;
-		emit positionMsChanged();
+		m_clock.update(pos, m_player.playbackState() == QMediaPlayer::PlayingState ? m_player.playbackRate() : 0);
 		updateCurrentLyricIndexByPosition(pos);
+		maybePrefetchNext(pos);
 	});
 	QObject::connect(&m_player, &QMediaPlayer::durationChanged, this, [this](qint64 dur) {
 		m_durationMs = dur;
+		m_clock.setDurationMs(dur);
 		emit durationMsChanged();
 	});
 	QObject::connect(&m_player, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error error, const QString &errorString) {
+		// 远程地址被拒绝（多为过期后的 403/410）：丢弃缓存的地址并重新解析一次，对用户透明
+		const bool urlRejected = error == QMediaPlayer::ResourceError || error == QMediaPlayer::NetworkError || error == QMediaPlayer::AccessDeniedError;
+		if (urlRejected && !m_currentUrl.isEmpty() && !m_currentUrl.isLocalFile() && !m_currentPlayback.audioKey.isEmpty() && !m_currentPlayback.urlRefreshed)
+		{
+			Logger::warning(QStringLiteral("Player rejected play url (%1), resolving again").arg(errorString));
+			m_currentPlayback.urlRefreshed = true;
+			playUrlCache.remove(m_currentPlayback.audioKey);
+			audioCache.cancel(m_currentPlayback.audioKey);
+			startPlayback(m_playRequestId, m_player.position());
+			return;
+		}
 		Logger::error(QStringLiteral("Player error: %1 - %2").arg(error).arg(errorString));
 		emit errorOccurred(errorString);
 	});
 
 	connect(&m_playlistModel, &SongListModel::rowRequested, this, &MusicController::onPlaylistRowRequested);
+	// 队列增删、重排或整体替换后，随机模式预抽的下一首不再可靠
+	connect(&m_queueModel, &QAbstractItemModel::modelReset, this, &MusicController::clearPrerolledNext);
+	connect(&m_queueModel, &QAbstractItemModel::rowsInserted, this, &MusicController::clearPrerolledNext);
+	connect(&m_queueModel, &QAbstractItemModel::rowsRemoved, this, &MusicController::clearPrerolledNext);
+	connect(&m_queueModel, &SongListModel::itemMoved, this, &MusicController::clearPrerolledNext);
 
 	loadQueueFromSettings();
     loadSearchHistory();
@@ -485,6 +667,14 @@ MusicController::MusicController(QObject *parent)
 
 MusicController::~MusicController()
 {
+	// 播放器销毁时会等待读取线程，先让阻塞在音频流上的读取返回
+	if (m_playbackStream)
+		m_playbackStream->abort();
+	if (unblockWorker)
+	{
+		delete unblockWorker;
+		unblockWorker = nullptr;
+	}
 	if (musicApiProcess)
 	{
 		if (musicApiProcess->state() != QProcess::NotRunning)
@@ -563,6 +753,7 @@ void MusicController::setPlaybackMode(int mode)
 	if (m_playbackMode == mode)
 		return;
 	m_playbackMode = mode;
+	clearPrerolledNext();
 	QSettings settings;
 	settings.beginGroup(QStringLiteral("set"));
 	settings.setValue(QStringLiteral("playbackMode"), m_playbackMode);
@@ -582,6 +773,11 @@ qint64 MusicController::positionMs() const
 	return m_positionMs;
 }
 
+PlaybackClock *MusicController::playbackClock()
+{
+	return &m_clock;
+}
+
 qint64 MusicController::durationMs() const
 {
 	return m_durationMs;
@@ -608,6 +804,7 @@ void MusicController::setLyricOffsetMs(qint64 v)
 		return;
 	m_lyricOffsetMs = v;
 	emit lyricOffsetMsChanged();
+	m_lyricModel.invalidateCursor();
 	updateCurrentLyricIndexByPosition(m_player.position());
 }
 
@@ -630,6 +827,7 @@ qint64 MusicController::currentLyricNextMs() const
 	// 若无下一行，则以歌曲总时长作为下一时间边界
 	return m_durationMs > 0 ? m_durationMs : lines.last().timeMs;
 }
+
 QUrl MusicController::coverSource() const
 {
 	return m_coverSource;
@@ -729,13 +927,28 @@ void MusicController::setLoading(bool v)
 	emit loadingChanged();
 }
 
-void MusicController::setCurrentUrl(const QUrl &url)
+void MusicController::setCurrentUrl(const QUrl &url, AudioStream *stream)
 {
-	if (m_currentUrl == url)
+	if (m_currentUrl == url && !stream)
 		return;
+	const bool changed = m_currentUrl != url;
 	m_currentUrl = url;
-	m_player.setSource(m_currentUrl);
-	emit currentUrlChanged();
+	// 先中止旧的音频流，播放器切换音源时不会卡在等待数据的读取上
+	QPointer<AudioStream> previous = m_playbackStream;
+	m_playbackStream = stream;
+	if (previous)
+		previous->abort();
+	if (stream)
+	{
+		stream->setParent(this);
+		m_player.setSourceDevice(stream, m_currentUrl);
+	}
+	else
+		m_player.setSource(m_currentUrl);
+	if (previous)
+		previous->deleteLater();
+	if (changed)
+		emit currentUrlChanged();
 }
 
 void MusicController::setPositionMs(qint64 v)
@@ -743,7 +956,7 @@ void MusicController::setPositionMs(qint64 v)
 	if (m_positionMs == v)
 		return;
 	m_positionMs = v;
-	emit positionMsChanged();
+	m_clock.sync(v, 0);
 }
 
 void MusicController::setDurationMs(qint64 v)
@@ -751,6 +964,7 @@ void MusicController::setDurationMs(qint64 v)
 	if (m_durationMs == v)
 		return;
 	m_durationMs = v;
+	m_clock.setDurationMs(v);
 	emit durationMsChanged();
 }
 
@@ -838,44 +1052,9 @@ void MusicController::updateCurrentLyricIndexByPosition(qint64 posMs)
 	qint64 effectivePosMs = posMs + m_lyricOffsetMs;
 	if (effectivePosMs < 0)
 		effectivePosMs = 0;
-	const QList<LyricLine> &lines = m_lyricModel.lyric().lines;
-	if (lines.isEmpty())
-	{
-		setCurrentLyricIndex(-1);
-		return;
-	}
-	bool anyTimestamp = false;
-	for (const LyricLine &l : lines)
-	{
-		if (l.timeMs > 0)
-		{
-			anyTimestamp = true;
-			break;
-		}
-	}
-	if (!anyTimestamp)
-	{
-		setCurrentLyricIndex(0);
-		return;
-	}
-	int lo = 0;
-	int hi = lines.size() - 1;
-	int best = 0;
-	while (lo <= hi)
-	{
-		int mid = (lo + hi) / 2;
-		qint64 t = lines.at(mid).timeMs;
-		if (t <= effectivePosMs)
-		{
-			best = mid;
-			lo = mid + 1;
-		}
-		else
-		{
-			hi = mid - 1;
-		}
-	}
-	setCurrentLyricIndex(best);
+	// 正常播放时游标只与下一行比较；跳转与偏移调整会让游标失效，改用二分查找
+	// 行内高亮进度由 QML 按帧调用 LyricListModel::highlightProgress 计算
+	setCurrentLyricIndex(m_lyricModel.advanceCursor(effectivePosMs));
 }
 
 void MusicController::clearLyric()
@@ -885,63 +1064,64 @@ void MusicController::clearLyric()
 	setCurrentLyricIndex(-1);
 }
 
-bool MusicController::lyricFromCache(const QString &key, Lyric &outLyric)
+// 读取与解码都在歌词缓存的 I/O 线程上完成，未命中或内容无效时回调空歌词
+void MusicController::lyricFromCache(const QString &key, const std::function<void(const Lyric &lyric)> &callback)
 {
-	QByteArray bytes;
-	if (!lyricCache.get(key, bytes))
-		return false;
-	QJsonParseError err{};
-	QJsonDocument doc = QJsonDocument::fromJson(bytes, &err);
-	if (err.error != QJsonParseError::NoError || !doc.isObject())
-		return false;
-	QJsonObject root = doc.object();
-	QJsonArray arr = root.value(QStringLiteral("lines")).toArray();
-	Lyric lyric;
-	lyric.lines.reserve(arr.size());
-	for (const QJsonValue &v : arr)
-	{
-		QJsonObject o = v.toObject();
-		LyricLine ll;
-		ll.timeMs = static_cast<qint64>(o.value(QStringLiteral("t")).toDouble());
-		ll.text = o.value(QStringLiteral("x")).toString();
-		QString trimmed = ll.text.trimmed();
-		if (trimmed.startsWith(QLatin1Char('{')) || trimmed.startsWith(QLatin1Char('[')))
-			continue;
-		lyric.lines.append(ll);
-	}
-	if (lyric.lines.isEmpty())
-		return false;
-	bool metaOnly = true;
-	for (const LyricLine &ll : lyric.lines)
-	{
-		QString t = ll.text.trimmed();
-		bool isMeta = (t.contains(QStringLiteral("\u4f5c\u8bcd")) || t.contains(QStringLiteral("\u4f5c\u66f2")) || t.contains(QStringLiteral("\u7f16\u66f2")) || t.startsWith(QStringLiteral("\u8bcd\uff1a")) || t.startsWith(QStringLiteral("\u66f2\uff1a")) || t.contains(QStringLiteral("\u5236\u4f5c\u4eba")));
-		if (!isMeta)
+	lyricCache.run<Lyric>([key](DiskCache &c) -> Lyric {
+		Lyric lyric;
+		const QString path = c.filePathForKey(key);
+		QFile f(path);
+		if (!f.open(QIODevice::ReadOnly))
+			return lyric;
+		// 直接在映射内存上解码，旧版 JSON 缓存因格式不符视为未命中，之后被网络结果覆盖
+		const qint64 size = f.size();
+		uchar *data = size > 0 ? f.map(0, size) : nullptr;
+		if (data)
 		{
-			metaOnly = false;
-			break;
+			LyricCacheFormat::decode(data, size, lyric);
+			f.unmap(data);
 		}
-	}
-	if (metaOnly)
-		return false;
-	outLyric = lyric;
-	return true;
+		f.close();
+		c.touch(path);
+		return lyric;
+	}, callback);
 }
 
+// 过滤与编码在写入时完成一次，结果随缓存保存
 void MusicController::saveLyricToCache(const QString &key, const Lyric &lyric)
 {
-	QJsonArray arr;
-	for (const LyricLine &ll : lyric.lines)
-	{
-		QJsonObject o;
-		o.insert(QStringLiteral("t"), static_cast<double>(ll.timeMs));
-		o.insert(QStringLiteral("x"), ll.text);
-		arr.append(o);
-	}
-	QJsonObject root;
-	root.insert(QStringLiteral("lines"), arr);
-	QJsonDocument doc(root);
-	lyricCache.put(key, doc.toJson(QJsonDocument::Compact));
+	lyricCache.post([key, lyric](DiskCache &c) {
+		c.put(key, LyricCacheFormat::encode(lyric));
+	});
+}
+
+template <typename T>
+QSharedPointer<RequestToken> MusicController::startBackgroundFetch(QHash<QString, QSharedPointer<PendingFetch<T>>> &pending, const QString &key, const std::function<QSharedPointer<RequestToken>(const std::function<void(Result<T>)> &)> &start, const std::function<void(const Result<T> &)> &onResult)
+{
+	QSharedPointer<PendingFetch<T>> entry = QSharedPointer<PendingFetch<T>>::create();
+	pending.insert(key, entry);
+	QSharedPointer<RequestToken> token = start([&pending, key, entry, onResult](Result<T> result) {
+		if (pending.value(key) == entry)
+			pending.remove(key);
+		if (onResult)
+			onResult(result);
+		const QList<std::function<void(Result<T>)>> waiters = std::exchange(entry->waiters, {});
+		for (const std::function<void(Result<T>)> &waiter : waiters)
+			waiter(result);
+	});
+	entry->token = token;
+	return token;
+}
+
+template <typename T>
+QSharedPointer<RequestToken> MusicController::joinBackgroundFetch(QHash<QString, QSharedPointer<PendingFetch<T>>> &pending, const QString &key, RequestPriority priority, const std::function<void(Result<T>)> &waiter)
+{
+	auto it = pending.constFind(key);
+	if (it == pending.constEnd() || !it.value()->token || it.value()->token->isCancelled())
+		return {};
+	it.value()->token->setPriority(priority);
+	it.value()->waiters.append(waiter);
+	return it.value()->token;
 }
 
 void MusicController::requestLyric(const QString &providerId, const QString &songId)
@@ -951,27 +1131,38 @@ void MusicController::requestLyric(const QString &providerId, const QString &son
 	if (lyricToken)
 		lyricToken->cancel();
 	QString key = providerId + QStringLiteral(":") + songId;
-	Lyric cached;
-	if (lyricFromCache(key, cached))
-	{
-		if (requestId == m_lyricRequestId)
+	lyricFromCache(key, [this, providerId, songId, key, requestId](const Lyric &cached) {
+		if (requestId != m_lyricRequestId)
+			return;
+		if (!cached.lines.isEmpty())
 		{
 			m_lyricModel.setLyric(cached);
 			updateCurrentLyricIndexByPosition(m_player.position());
+			// 预取刚从网络拉取过，不必再刷新
+			if (m_prefetchedLyricKey == key)
+			{
+				m_prefetchedLyricKey.clear();
+				return;
+			}
 		}
-	}
-	lyricToken = providerManager.lyric(songId, [this, key, requestId](Result<Lyric> result) {
-		if (requestId != m_lyricRequestId)
-			return;
-		if (!result.ok)
-		{
-			clearLyric();
+		auto onResult = [this, key, requestId](Result<Lyric> result) {
+			if (requestId != m_lyricRequestId)
+				return;
+			if (!result.ok)
+			{
+				clearLyric();
+				return;
+			}
+			saveLyricToCache(key, result.value);
+			m_lyricModel.setLyric(result.value);
+			updateCurrentLyricIndexByPosition(m_player.position());
+		};
+		// 预取或预热正在拉取同一份歌词时直接等待其结果
+		lyricToken = joinBackgroundFetch<Lyric>(m_pendingLyrics, key, RequestPriority::CurrentMedia, onResult);
+		if (lyricToken)
 			return;
-		}
-		saveLyricToCache(key, result.value);
-		m_lyricModel.setLyric(result.value);
-		updateCurrentLyricIndexByPosition(m_player.position());
-	}, QStringList() << providerId);
+		lyricToken = providerManager.lyric(songId, onResult, QStringList() << providerId);
+	});
 }
 
 
@@ -985,77 +1176,87 @@ void MusicController::requestCover(const QUrl &coverUrl)
 		setCoverSource({});
 		return;
 	}
-	QString key = coverUrl.toString();
-	QStringList exts{QStringLiteral("png"), QStringLiteral("jpg"), QStringLiteral("jpeg"), QStringLiteral("gif"), QStringLiteral("bmp")};
-	if (imageCache.containsAny(key, exts))
-	{
-		if (requestId != m_coverRequestId)
-			return;
-		QUrl u = imageCache.resolveExistingFileUrlForKey(key, exts);
-		setCoverSource(u);
-		return;
-	}
+	// 同一张封面只按规范 key 缓存一份母版，不同尺寸参数与歌曲共用
+	QString key = CoverUrl::canonicalKey(coverUrl);
 	if (coverToken)
 		coverToken->cancel();
-	coverToken = providerManager.cover(coverUrl, [this, key, requestId, coverUrl](Result<QByteArray> result) {
+	imageCache.resolveExisting(key, coverExts(), [this, key, requestId, coverUrl](const QString &path) {
 		if (requestId != m_coverRequestId)
 			return;
-		if (!result.ok)
+		if (!path.isEmpty())
 		{
-			Logger::warning(QStringLiteral("Cover fetch failed: %1").arg(coverUrl.toString()));
+			setCoverSource(QUrl::fromLocalFile(path));
 			return;
 		}
-		auto sniffExt = [](const QByteArray &data) -> QString {
-			if (data.size() >= 8)
+		// 预取或预热正在下载同一张封面：其回调先提交写入，图片缓存的 I/O 线程按提交顺序执行，之后查找即可取到文件
+		coverToken = joinBackgroundFetch<QByteArray>(m_pendingCovers, key, RequestPriority::CurrentMedia, [this, key, requestId, coverUrl](Result<QByteArray> result) {
+			if (requestId != m_coverRequestId)
+				return;
+			if (!result.ok)
 			{
-				const uchar *p = reinterpret_cast<const uchar *>(data.constData());
-				if (p[0] == 0x89 && p[1] == 0x50 && p[2] == 0x4E && p[3] == 0x47 && p[4] == 0x0D && p[5] == 0x0A && p[6] == 0x1A && p[7] == 0x0A)
-					return QStringLiteral("png");
+				Logger::warning(QStringLiteral("Cover fetch failed: %1").arg(coverUrl.toString()));
+				return;
 			}
-			if (data.size() >= 3)
+			imageCache.resolveExisting(key, coverExts(), [this, requestId, coverUrl](const QString &stored) {
+				if (requestId != m_coverRequestId)
+					return;
+				setCoverSource(stored.isEmpty() ? coverUrl : QUrl::fromLocalFile(stored));
+			});
+		});
+		if (coverToken)
+			return;
+		coverToken = providerManager.cover(CoverUrl::master(coverUrl), [this, key, requestId, coverUrl](Result<QByteArray> result) {
+			if (requestId != m_coverRequestId)
+				return;
+			if (!result.ok)
 			{
-				const uchar *p = reinterpret_cast<const uchar *>(data.constData());
-				if (p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF)
-					return QStringLiteral("jpg");
+				Logger::warning(QStringLiteral("Cover fetch failed: %1").arg(coverUrl.toString()));
+				return;
 			}
-			if (data.size() >= 6 && (QByteArray(data.constData(), 6) == QByteArray("GIF87a") || QByteArray(data.constData(), 6) == QByteArray("GIF89a")))
-				return QStringLiteral("gif");
-			if (data.size() >= 2 && QByteArray(data.constData(), 2) == QByteArray("BM"))
-				return QStringLiteral("bmp");
-			return QString();
-		};
-		QString ext = sniffExt(result.value);
-		if (ext.isEmpty())
-		{
-			QBuffer buf;
-			buf.setData(result.value);
-			buf.open(QIODevice::ReadOnly);
-			QImageReader reader(&buf);
-			QImage img = reader.read();
-			if (!img.isNull())
-			{
-				QBuffer out;
-				out.open(QIODevice::WriteOnly);
-				QImageWriter w(&out, "PNG");
-				if (w.write(img))
+			storeCoverImage(key, result.value, [this, requestId, coverUrl](const QUrl &u) {
+				if (requestId != m_coverRequestId)
+					return;
+				if (u.isEmpty())
 				{
-					imageCache.putWithExt(key, out.data(), QStringLiteral("png"));
-					QUrl u = imageCache.fileUrlForKeyExt(key, QStringLiteral("png"));
-					setCoverSource(u);
+					// 无法解析，直接使用远程地址作为兜底
+					Logger::warning(QStringLiteral("Cover decode failed, using remote url: %1").arg(coverUrl.toString()));
+					setCoverSource(coverUrl);
 					return;
 				}
-			}
-			// 无法解析，直接使用远程地址作为兜底
-			Logger::warning(QStringLiteral("Cover decode failed, using remote url: %1").arg(coverUrl.toString()));
-			setCoverSource(coverUrl);
+				setCoverSource(u);
+			});
+		});
+	});
+}
+
+CoverImageProvider *MusicController::createCoverImageProvider()
+{
+	QPointer<MusicController> self(this);
+	return new CoverImageProvider([self](const QUrl &url, const std::function<void(Result<QByteArray>)> &callback) -> QSharedPointer<RequestToken> {
+		if (!self)
+		{
+			callback(Result<QByteArray>::failure(Error{ErrorCategory::Network, -2, QStringLiteral("Request cancelled")}));
+			return {};
+		}
+		return self->providerManager.cover(url, callback);
+	}, [self](const QString &key, const std::function<void(const QString &path)> &callback) {
+		if (!self)
+		{
+			callback(QString());
 			return;
 		}
-		imageCache.putWithExt(key, result.value, ext);
-		QUrl u = imageCache.fileUrlForKeyExt(key, ext);
-		setCoverSource(u);
+		self->imageCache.resolveExisting(key, coverExts(), callback);
 	});
 }
 
+// 格式识别、解码与写入都在图片缓存的 I/O 线程上完成，回调缓存文件地址，解码失败时回调空地址
+void MusicController::storeCoverImage(const QString &key, const QByteArray &data, const std::function<void(const QUrl &fileUrl)> &callback)
+{
+	imageCache.run<QUrl>([key, data](DiskCache &c) -> QUrl {
+		return writeCoverImage(c, key, data);
+	}, callback);
+}
+
 void MusicController::setPlaying(bool v)
 {
 	if (m_playing == v)
@@ -1277,6 +1478,8 @@ void MusicController::playIndex(int index)
 	if (index < 0 || index >= m_queueModel.rowCount())
 		return;
 	setCurrentSongIndex(index);
+	// 预抽的下一首只用于本次切歌，之后每次前进都重新抽取
+	clearPrerolledNext();
 	// 记录本次播放序号，避免旧 playUrl 回调覆盖当前播放
 	quint64 requestId = ++m_playRequestId;
 	if (playUrlToken)
@@ -1315,16 +1518,61 @@ void MusicController::playIndex(int index)
 			if (detail.value.album.coverUrl.isValid() && !detail.value.album.coverUrl.isEmpty())
 				requestCover(detail.value.album.coverUrl);
 		}, QStringList() << prefer << QStringLiteral("netease"));
+		if (songDetailToken)
+			songDetailToken->setPriority(RequestPriority::CurrentMedia);
+	}
+	const QString lyricProvider = lyricProviderFor(song);
+	if (!lyricProvider.isEmpty())
+		requestLyric(lyricProvider, songId);
+	QString opaqueSongId = playbackSongId(song);
+	// 同一时间只为当前歌曲写缓存，切歌后旧下载保留部分文件，下次续传
+	const QString audioKey = AudioCache::cacheKey(providerId, opaqueSongId, readQualityLevel());
+	audioCache.cancelAllExcept(audioKey);
+	// 切到的正是预取的下一首时，保留仍在进行的预取请求，由上面的歌词、封面与下面的播放地址请求接管
+	QStringList keepKeys{audioKey};
+	if (!lyricProvider.isEmpty())
+		keepKeys.append(lyricProvider + QStringLiteral(":") + songId);
+	if (song.album.coverUrl.isValid() && !song.album.coverUrl.isEmpty())
+		keepKeys.append(CoverUrl::canonicalKey(song.album.coverUrl));
+	cancelPrefetch(keepKeys);
+	cancelWarmUp(keepKeys);
+	m_currentPlayback = CurrentPlayback();
+	m_currentPlayback.providerId = providerId;
+	m_currentPlayback.opaqueSongId = opaqueSongId;
+	m_currentPlayback.audioKey = audioKey;
+	// 已完整缓存：直接播放本地文件，不再解析播放地址
+	audioCache.lookup(audioKey, [this, requestId](const QUrl &cachedAudio) {
+		if (requestId != m_playRequestId)
+			return;
+		if (!cachedAudio.isValid())
+		{
+			startPlayback(requestId, 0);
+			return;
+		}
+		setLoading(false);
+		if (m_currentUrl == cachedAudio)
+			m_player.setPosition(0);
+		setCurrentUrl(cachedAudio);
+		m_player.play();
+	});
+}
+
+// 播放地址优先取未过期的缓存（包括下一首预取的结果），否则走完整的解析链路
+void MusicController::startPlayback(quint64 requestId, qint64 resumeAtMs)
+{
+	const QString audioKey = m_currentPlayback.audioKey;
+	PlayUrl cached;
+	if (playUrlCache.get(audioKey, cached))
+	{
+		Logger::debug(QStringLiteral("PlayUrl cache hit: %1").arg(audioKey));
+		setLoading(false);
+		beginRemotePlayback(cached.url, resumeAtMs);
+		return;
 	}
-	if (providerId == QStringLiteral("netease"))
-		requestLyric(providerId, songId);
-	else if (source == QStringLiteral("netease"))
-		requestLyric(QStringLiteral("netease"), songId);
 	setLoading(true);
-	QString opaqueSongId = songId;
-	if (providerId == QStringLiteral("gdstudio"))
-		opaqueSongId = source + QStringLiteral(":") + songId;
-	playUrlToken = providerManager.playUrl(opaqueSongId, [this, requestId](Result<PlayUrl> result) {
+	if (playUrlToken)
+		playUrlToken->cancel();
+	auto onResult = [this, requestId, audioKey, resumeAtMs](Result<PlayUrl> result) {
 		if (requestId != m_playRequestId)
 			return;
 		setLoading(false);
@@ -1334,9 +1582,61 @@ void MusicController::playIndex(int index)
 			emit errorOccurred(result.error.message);
 			return;
 		}
-		setCurrentUrl(result.value.url);
-		m_player.play();
-	}, QStringList() << providerId);
+		cachePlayUrl(audioKey, result.value);
+		beginRemotePlayback(result.value.url, resumeAtMs);
+	};
+	// 预取或预热正在解析同一首歌的地址：提升为播放优先级并等待其结果，不重新发起
+	playUrlToken = joinBackgroundFetch<PlayUrl>(m_pendingPlayUrls, audioKey, RequestPriority::Playback, onResult);
+	if (playUrlToken)
+	{
+		Logger::debug(QStringLiteral("PlayUrl joined background request: %1").arg(audioKey));
+		return;
+	}
+	playUrlToken = providerManager.playUrl(m_currentPlayback.opaqueSongId, onResult, playUrlProvidersFor(m_currentPlayback.providerId));
+}
+
+void MusicController::beginRemotePlayback(const QUrl &url, qint64 resumeAtMs)
+{
+	// 边下边播：播放器读取的数据与音频缓存共用同一次下载（包括已预取的开头），下载完成后再次播放直接使用本地文件
+	AudioStream *stream = audioCache.openStream(m_currentPlayback.audioKey, url);
+	// 刷新后的地址与旧地址相同时也要重新加载
+	if (!stream && m_currentUrl == url)
+		setCurrentUrl(QUrl());
+	setCurrentUrl(url, stream);
+	if (resumeAtMs > 0)
+		m_player.setPosition(resumeAtMs);
+	m_player.play();
+}
+
+// 有效期取自来源给出的过期时间，缺失时按策略使用默认值；预留余量，避免临近过期的地址在播放途中失效
+void MusicController::cachePlayUrl(const QString &key, const PlayUrl &playUrl)
+{
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	qint64 ttlMs = 0;
+	if (playUrl.expiresAtMs > 0)
+	{
+		ttlMs = playUrl.expiresAtMs - now;
+	}
+	else
+	{
+		// 部分 CDN 地址在查询参数中携带过期时间（秒级时间戳）
+		const QUrlQuery query(playUrl.url);
+		const QString expires = query.hasQueryItem(QStringLiteral("Expires")) ? query.queryItemValue(QStringLiteral("Expires")) : query.queryItemValue(QStringLiteral("expires"));
+		bool ok = false;
+		const qint64 expiresAt = expires.toLongLong(&ok);
+		if (ok && expiresAt > now / 1000)
+			ttlMs = expiresAt * 1000 - now;
+		else if (playUrl.strategy == QStringLiteral("netease"))
+			ttlMs = 20 * 60 * 1000;
+		else if (playUrl.strategy == QStringLiteral("gdstudio"))
+			ttlMs = 10 * 60 * 1000;
+		else
+			ttlMs = 5 * 60 * 1000;
+	}
+	ttlMs -= qMax<qint64>(30 * 1000, ttlMs / 10);
+	if (ttlMs <= 0)
+		return;
+	playUrlCache.set(key, playUrl, static_cast<int>(qMin<qint64>(ttlMs, 60 * 60 * 1000)));
 }
 
 void MusicController::playPrev()
@@ -1553,6 +1853,9 @@ void MusicController::onPlaylistRowRequested(int index)
 	{
 		loadPlaylistPage(page);
 	}
+	// 之前作为预取发出的页现在已可见，提升其优先级
+	if (auto token = m_playlistPageTokens.value(page))
+		token->setPriority(RequestPriority::VisibleData);
 
 	// Prefetch next 2 pages
 	for (int i = 1; i <= 2; ++i) {
@@ -1562,6 +1865,8 @@ void MusicController::onPlaylistRowRequested(int index)
 			if (!m_playlistModel.isLoaded(nextPage * pageSize) && !m_requestedPages.contains(nextPage))
 			{
 				loadPlaylistPage(nextPage);
+				if (auto token = m_playlistPageTokens.value(nextPage))
+					token->setPriority(RequestPriority::Prefetch);
 			}
 		}
 	}
@@ -1703,67 +2008,123 @@ void MusicController::importPlaylistToQueue(const QString &playlistId, bool clea
     int limit = 1000; 
     int offset = 0;
 
-    importToken = providerManager.playlistTracks(targetId, limit, offset, [this, clearFirst, playSongId, preventReplay](Result<PlaylistTracksPage> result) {
-        importToken.clear();
-        if (!result.ok) {
-            emit errorOccurred("Import failed: " + result.error.message);
-            return;
-        }
-
-        QList<Song> songs = result.value.songs;
-        if (songs.isEmpty()) {
-             emit errorOccurred("Playlist is empty");
-             return;
-        }
+    auto songKey = [](const Song &x) {
+        QString p = x.providerId.isEmpty() ? x.source : x.providerId;
+        return p + QStringLiteral(":") + x.id;
+    };
 
-        auto songKey = [](const Song &x) {
-            QString p = x.providerId.isEmpty() ? x.source : x.providerId;
-            return p + QStringLiteral(":") + x.id;
-        };
-        
-        QList<Song> queue;
+    // 流式导入：歌曲分批到达即写入队列，目标歌曲一出现就开始播放，无需等待整个歌单
+    struct ImportState
+    {
         QSet<QString> existingKeys;
+        // 尚未写入队列的歌曲：需要定位的目标歌曲出现前先暂存，避免当前索引指向错误的歌曲
+        QList<Song> pending;
+        bool applied = false;
+        bool targetHandled = false;
+        int received = 0;
+    };
+    QSharedPointer<ImportState> state = QSharedPointer<ImportState>::create();
+    if (!clearFirst) {
+        for (const Song &s : m_queueModel.songs())
+            state->existingKeys.insert(songKey(s));
+    }
+    if (playSongId.isEmpty())
+        state->targetHandled = true;
 
-        if (!clearFirst) {
-            queue = m_queueModel.songs();
-            for (const Song &s : queue) {
-                existingKeys.insert(songKey(s));
-            }
-        }
-        
-        int added = 0;
-        for (const Song &s : songs) {
+    // 把暂存的歌曲写入队列，首次写入时按 clearFirst 决定替换还是追加
+    auto flush = [this, state, clearFirst]() {
+        if (state->pending.isEmpty())
+            return;
+        if (!state->applied && clearFirst)
+            m_queueModel.setSongs(state->pending);
+        else
+            m_queueModel.append(state->pending);
+        state->applied = true;
+        state->pending.clear();
+    };
+
+    auto onBatch = [this, state, songKey, flush, clearFirst, playSongId, preventReplay](const QList<Song> &batch) {
+        state->received += batch.size();
+        int targetOffset = -1;
+        // 追加模式下目标歌曲可能已在原队列中，此时直接播放原有的那一行
+        int existingIndex = -1;
+        for (const Song &s : batch) {
             if (s.id.isEmpty()) continue;
             QString key = songKey(s);
-            if (!existingKeys.contains(key)) {
-                queue.append(s);
-                existingKeys.insert(key);
-                added++;
+            if (state->existingKeys.contains(key)) {
+                if (!clearFirst && !state->targetHandled && existingIndex < 0 && playSongId != QStringLiteral("FIRST") && s.id == playSongId) {
+                    const QList<Song> &queued = m_queueModel.songs();
+                    for (int i = 0; i < queued.size(); ++i) {
+                        if (songKey(queued.at(i)) == key) {
+                            existingIndex = i;
+                            break;
+                        }
+                    }
+                }
+                continue;
             }
-        }
-        
-        if (added > 0 || clearFirst) {
-            m_queueModel.setSongs(queue);
-            saveQueueToSettings();
+            state->existingKeys.insert(key);
+            state->pending.append(s);
+            if (!state->targetHandled && targetOffset < 0 && playSongId != QStringLiteral("FIRST") && s.id == playSongId)
+                targetOffset = state->pending.size() - 1;
         }
 
-        if (!playSongId.isEmpty()) {
-            if (playSongId == QStringLiteral("FIRST") && !queue.isEmpty()) {
-                 playIndex(0);
-                 return;
-            }
-            for (int i = 0; i < queue.size(); ++i) {
-                if (queue.at(i).id == playSongId) {
-                    if (preventReplay && m_currentSongId == playSongId) {
-                         setCurrentSongIndex(i);
-                         saveQueueToSettings();
-                         return;
-                    }
-                    playIndex(i);
-                    return;
-                }
+        if (state->targetHandled) {
+            flush();
+            return;
+        }
+        if (playSongId == QStringLiteral("FIRST")) {
+            if (state->pending.isEmpty() && !state->applied)
+                return;
+            flush();
+            state->targetHandled = true;
+            if (m_queueModel.rowCount() > 0)
+                playIndex(0);
+            return;
+        }
+        if (targetOffset < 0 && existingIndex >= 0) {
+            // 追加只会写到队列末尾，原有行的位置不变
+            flush();
+            state->targetHandled = true;
+            if (preventReplay && m_currentSongId == playSongId) {
+                setCurrentSongIndex(existingIndex);
+                return;
             }
+            playIndex(existingIndex);
+            return;
+        }
+        if (targetOffset < 0)
+            return;
+
+        // 暂存歌曲在队列中的起始位置：首次替换时从 0 开始，否则接在现有队列之后
+        int queueStart = (!state->applied && clearFirst) ? 0 : m_queueModel.rowCount();
+        flush();
+        state->targetHandled = true;
+        int index = queueStart + targetOffset;
+        if (preventReplay && m_currentSongId == playSongId) {
+            setCurrentSongIndex(index);
+            return;
         }
+        playIndex(index);
+    };
+
+    importToken = providerManager.playlistTracksStream(targetId, limit, offset, onBatch, [this, state, flush, playSongId](Result<PlaylistTracksPage> result) {
+        importToken.clear();
+        // 目标歌曲不在歌单中时，暂存的歌曲在结束时统一写入
+        flush();
+        if (state->applied)
+            saveQueueToSettings();
+
+        if (!result.ok) {
+            emit errorOccurred("Import failed: " + result.error.message);
+            return;
+        }
+        if (state->received == 0) {
+            emit errorOccurred("Playlist is empty");
+            return;
+        }
+        if (!state->targetHandled)
+            Logger::debug(QStringLiteral("Import playlist: song %1 not found in playlist").arg(playSongId));
     });
 }
 
@@ -1787,7 +2148,10 @@ void MusicController::seek(qint64 positionMs)
 	qint64 dur = m_player.duration();
 	if (dur > 0 && positionMs > dur)
 		positionMs = dur;
+	m_lyricModel.invalidateCursor();
 	m_player.setPosition(positionMs);
+	// 立即发布同步点，避免 QML 在新位置上报前仍从旧位置外推
+	m_clock.sync(positionMs, m_player.playbackState() == QMediaPlayer::PlayingState ? m_player.playbackRate() : 0);
 }
 
 void MusicController::pause()
@@ -1797,6 +2161,12 @@ void MusicController::pause()
 
 void MusicController::resume()
 {
+	// 启动后恢复的当前歌曲尚未加载，按下播放时直接播放它（预热过的地址与缓存会被复用）
+	if (m_playRequestId == 0 && m_currentUrl.isEmpty() && m_currentSongIndex >= 0)
+	{
+		playIndex(m_currentSongIndex);
+		return;
+	}
 	m_player.play();
 }
 
@@ -1814,45 +2184,183 @@ void MusicController::handleMediaFinished()
 }
 
 void MusicController::playNextInternal(bool fromUser)
+{
+	Q_UNUSED(fromUser);
+	int nextIndex = peekNextIndex();
+	if (nextIndex < 0)
+		return;
+	playIndex(nextIndex);
+}
+
+int MusicController::peekNextIndex()
 {
 	int count = m_queueModel.rowCount();
 	if (count <= 0)
-		return;
+		return -1;
 	if (m_currentSongIndex < 0)
-	{
-		playIndex(0);
-		return;
-	}
+		return 0;
 
 	if (m_playbackMode == static_cast<int>(Random))
 	{
 		if (count == 1)
-		{
-			playIndex(0);
-			return;
-		}
+			return 0;
+		if (m_prerolledFromIndex == m_currentSongIndex && m_prerolledQueueCount == count && m_prerolledNextIndex >= 0 && m_prerolledNextIndex < count)
+			return m_prerolledNextIndex;
 		int nextIndex = m_currentSongIndex;
 		for (int i = 0; i < 6 && nextIndex == m_currentSongIndex; ++i)
 			nextIndex = QRandomGenerator::global()->bounded(count);
 		if (nextIndex == m_currentSongIndex)
 			nextIndex = (m_currentSongIndex + 1) % count;
-		playIndex(nextIndex);
-		return;
+		m_prerolledNextIndex = nextIndex;
+		m_prerolledFromIndex = m_currentSongIndex;
+		m_prerolledQueueCount = count;
+		return nextIndex;
 	}
 
 	if (m_playbackMode == static_cast<int>(LoopAll))
-	{
-		playIndex((m_currentSongIndex + 1) % count);
-		return;
-	}
+		return (m_currentSongIndex + 1) % count;
 
 	if (m_currentSongIndex + 1 >= count)
+		return -1;
+	return m_currentSongIndex + 1;
+}
+
+void MusicController::clearPrerolledNext()
+{
+	m_prerolledNextIndex = -1;
+	m_prerolledFromIndex = -1;
+	m_prerolledQueueCount = 0;
+}
+
+void MusicController::maybePrefetchNext(qint64 posMs)
+{
+	if (m_currentSongIndex < 0 || m_nextPrefetch.playRequestId == m_playRequestId)
+		return;
+	const qint64 dur = m_player.duration();
+	if (dur <= 0)
+		return;
+	if (posMs < static_cast<qint64>(dur * m_prefetchAtRatio) && dur - posMs > m_prefetchBeforeEndMs)
+		return;
+	prefetchNext();
+}
+
+void MusicController::prefetchNext()
+{
+	cancelPrefetch();
+	m_nextPrefetch.playRequestId = m_playRequestId;
+	const int nextIndex = peekNextIndex();
+	if (nextIndex < 0 || nextIndex == m_currentSongIndex || nextIndex >= m_queueModel.rowCount())
+		return;
+	const Song song = m_queueModel.songs().at(nextIndex);
+	const QString opaqueSongId = playbackSongId(song);
+	const QString audioKey = AudioCache::cacheKey(song.providerId, opaqueSongId, readQualityLevel());
+	m_nextPrefetch.audioKey = audioKey;
+	Logger::debug(QStringLiteral("Prefetch next track: %1 (%2)").arg(song.name).arg(audioKey));
+
+	if (song.album.coverUrl.isValid() && !song.album.coverUrl.isEmpty())
+	{
+		m_nextPrefetch.coverKey = CoverUrl::canonicalKey(song.album.coverUrl);
+		prefetchCover(song.album.coverUrl);
+	}
+	const QString lyricProvider = lyricProviderFor(song);
+	if (!lyricProvider.isEmpty())
 	{
-		if (!fromUser)
+		m_nextPrefetch.lyricKey = lyricProvider + QStringLiteral(":") + song.id;
+		prefetchLyric(lyricProvider, song.id);
+	}
+
+	const quint64 playRequestId = m_playRequestId;
+	const QString providerId = song.providerId;
+	audioCache.lookup(audioKey, [this, playRequestId, audioKey, opaqueSongId, providerId](const QUrl &cachedAudio) {
+		if (cachedAudio.isValid() || playRequestId != m_playRequestId || m_nextPrefetch.audioKey != audioKey)
 			return;
-		return;
+		PlayUrl cachedUrl;
+		if (playUrlCache.get(audioKey, cachedUrl))
+		{
+			if (m_prefetchAudioBytes > 0)
+				audioCache.fetch(audioKey, cachedUrl.url, RequestPriority::Prefetch, m_prefetchAudioBytes);
+			return;
+		}
+		prefetchUrlToken = startBackgroundFetch<PlayUrl>(m_pendingPlayUrls, audioKey, [this, opaqueSongId, providerId](const std::function<void(Result<PlayUrl>)> &cb) {
+			return providerManager.playUrl(opaqueSongId, cb, playUrlProvidersFor(providerId));
+		}, [this, playRequestId, audioKey](const Result<PlayUrl> &result) {
+			if (!result.ok)
+			{
+				Logger::debug(QStringLiteral("Prefetch play url failed: %1").arg(result.error.message));
+				return;
+			}
+			// 地址总是写入缓存；已切到这首歌时由正式播放下载音频，不再预下载开头
+			cachePlayUrl(audioKey, result.value);
+			if (playRequestId == m_playRequestId && m_nextPrefetch.audioKey == audioKey && m_prefetchAudioBytes > 0)
+				audioCache.fetch(audioKey, result.value.url, RequestPriority::Prefetch, m_prefetchAudioBytes);
+		});
+		if (prefetchUrlToken)
+			prefetchUrlToken->setPriority(RequestPriority::Prefetch);
+	});
+}
+
+void MusicController::cancelPrefetch(const QStringList &keepKeys)
+{
+	// 被取消的请求不再回调，同时移出登记表
+	if (prefetchUrlToken && !keepKeys.contains(m_nextPrefetch.audioKey))
+	{
+		prefetchUrlToken->cancel();
+		m_pendingPlayUrls.remove(m_nextPrefetch.audioKey);
+	}
+	if (prefetchLyricToken && !keepKeys.contains(m_nextPrefetch.lyricKey))
+	{
+		prefetchLyricToken->cancel();
+		m_pendingLyrics.remove(m_nextPrefetch.lyricKey);
+	}
+	if (prefetchCoverToken && !keepKeys.contains(m_nextPrefetch.coverKey))
+	{
+		prefetchCoverToken->cancel();
+		m_pendingCovers.remove(m_nextPrefetch.coverKey);
 	}
-	playIndex(m_currentSongIndex + 1);
+	prefetchUrlToken.reset();
+	prefetchLyricToken.reset();
+	prefetchCoverToken.reset();
+	m_nextPrefetch = NextPrefetch();
+}
+
+// 只写入图片缓存，不改变当前封面
+void MusicController::prefetchCover(const QUrl &coverUrl)
+{
+	const QString key = CoverUrl::canonicalKey(coverUrl);
+	const quint64 playRequestId = m_playRequestId;
+	imageCache.resolveExisting(key, coverExts(), [this, key, coverUrl, playRequestId](const QString &path) {
+		if (!path.isEmpty() || playRequestId != m_nextPrefetch.playRequestId)
+			return;
+		prefetchCoverToken = startBackgroundFetch<QByteArray>(m_pendingCovers, key, [this, coverUrl](const std::function<void(Result<QByteArray>)> &cb) {
+			return providerManager.cover(CoverUrl::master(coverUrl), cb);
+		}, [this, key](const Result<QByteArray> &result) {
+			if (result.ok)
+				storeCoverImage(key, result.value, {});
+		});
+		if (prefetchCoverToken)
+			prefetchCoverToken->setPriority(RequestPriority::Prefetch);
+	});
+}
+
+// 只写入歌词缓存，不改变当前歌词
+void MusicController::prefetchLyric(const QString &providerId, const QString &songId)
+{
+	const QString key = providerId + QStringLiteral(":") + songId;
+	const quint64 playRequestId = m_playRequestId;
+	lyricFromCache(key, [this, providerId, songId, key, playRequestId](const Lyric &cached) {
+		if (!cached.lines.isEmpty() || playRequestId != m_nextPrefetch.playRequestId)
+			return;
+		prefetchLyricToken = startBackgroundFetch<Lyric>(m_pendingLyrics, key, [this, providerId, songId](const std::function<void(Result<Lyric>)> &cb) {
+			return providerManager.lyric(songId, cb, QStringList() << providerId);
+		}, [this, key](const Result<Lyric> &result) {
+			if (!result.ok)
+				return;
+			saveLyricToCache(key, result.value);
+			m_prefetchedLyricKey = key;
+		});
+		if (prefetchLyricToken)
+			prefetchLyricToken->setPriority(RequestPriority::Prefetch);
+	});
 }
 
 void MusicController::playPrevInternal(bool fromUser)
@@ -2036,6 +2544,7 @@ void MusicController::saveQueueToSettings()
 	QSettings settings;
 	settings.beginGroup(QStringLiteral("queue"));
 	settings.setValue(QStringLiteral("items"), QString::fromUtf8(doc.toJson(QJsonDocument::Compact)));
+	settings.setValue(QStringLiteral("currentIndex"), m_currentSongIndex);
 	settings.endGroup();
 }
 
@@ -2044,6 +2553,7 @@ void MusicController::loadQueueFromSettings()
 	QSettings settings;
 	settings.beginGroup(QStringLiteral("queue"));
 	QString json = settings.value(QStringLiteral("items"), QString()).toString();
+	const int currentIndex = settings.value(QStringLiteral("currentIndex"), -1).toInt();
 	settings.endGroup();
 	if (json.trimmed().isEmpty())
 		return;
@@ -2078,6 +2588,122 @@ void MusicController::loadQueueFromSettings()
 		restored.append(s);
 	}
 	m_queueModel.setSongs(restored);
+	// 恢复上次的当前歌曲，只显示信息不自动播放；按下播放时从这里开始
+	if (currentIndex >= 0 && currentIndex < restored.size())
+	{
+		const Song &song = restored.at(currentIndex);
+		QStringList artistNames;
+		for (const Artist &a : song.artists)
+			artistNames.append(a.name);
+		m_currentSongId = song.id;
+		setCurrentSongIndex(currentIndex);
+		setCurrentSongTitle(song.name);
+		setCurrentSongArtists(artistNames.join(QStringLiteral(" / ")));
+	}
+}
+
+void MusicController::startWarmUp()
+{
+	// 用户已经开始播放时不再预热
+	const int count = m_queueModel.rowCount();
+	if (m_playRequestId != 0 || m_currentSongIndex < 0 || m_currentSongIndex >= count)
+		return;
+	cancelWarmUp();
+	const quint64 warmUpId = ++m_warmUpId;
+	const QList<Song> songs = m_queueModel.songs();
+	const int n = qMin(count, m_warmUpCount);
+	Logger::debug(QStringLiteral("Warm up restored queue: %1 tracks from index %2").arg(n).arg(m_currentSongIndex));
+	for (int i = 0; i < n; ++i)
+		warmUpSong(songs.at((m_currentSongIndex + i) % count), i == 0, warmUpId);
+}
+
+// 缓存已有的封面与歌词只做校验；播放地址只写入内存缓存，当前歌曲额外预下载音频开头
+void MusicController::warmUpSong(const Song &song, bool current, quint64 warmUpId)
+{
+	const QUrl coverUrl = song.album.coverUrl;
+	if (coverUrl.isValid() && !coverUrl.isEmpty())
+	{
+		const QString key = CoverUrl::canonicalKey(coverUrl);
+		imageCache.resolveExisting(key, coverExts(), [this, key, coverUrl, warmUpId](const QString &path) {
+			if (!path.isEmpty() || warmUpId != m_warmUpId)
+				return;
+			keepWarmUpToken(key, startBackgroundFetch<QByteArray>(m_pendingCovers, key, [this, coverUrl](const std::function<void(Result<QByteArray>)> &cb) {
+				return providerManager.cover(CoverUrl::master(coverUrl), cb);
+			}, [this, key](const Result<QByteArray> &result) {
+				if (result.ok)
+					storeCoverImage(key, result.value, {});
+			}));
+		});
+	}
+
+	const QString lyricProvider = lyricProviderFor(song);
+	if (!lyricProvider.isEmpty())
+	{
+		const QString songId = song.id;
+		const QString key = lyricProvider + QStringLiteral(":") + songId;
+		lyricFromCache(key, [this, lyricProvider, songId, key, current, warmUpId](const Lyric &cached) {
+			if (!cached.lines.isEmpty() || warmUpId != m_warmUpId)
+				return;
+			keepWarmUpToken(key, startBackgroundFetch<Lyric>(m_pendingLyrics, key, [this, lyricProvider, songId](const std::function<void(Result<Lyric>)> &cb) {
+				return providerManager.lyric(songId, cb, QStringList() << lyricProvider);
+			}, [this, key, current](const Result<Lyric> &result) {
+				if (!result.ok)
+					return;
+				saveLyricToCache(key, result.value);
+				if (current)
+					m_prefetchedLyricKey = key;
+			}));
+		});
+	}
+
+	const QString opaqueSongId = playbackSongId(song);
+	const QString audioKey = AudioCache::cacheKey(song.providerId, opaqueSongId, readQualityLevel());
+	const QString providerId = song.providerId;
+	audioCache.lookup(audioKey, [this, audioKey, opaqueSongId, providerId, current, warmUpId](const QUrl &cachedAudio) {
+		if (cachedAudio.isValid() || warmUpId != m_warmUpId)
+			return;
+		keepWarmUpToken(audioKey, startBackgroundFetch<PlayUrl>(m_pendingPlayUrls, audioKey, [this, opaqueSongId, providerId](const std::function<void(Result<PlayUrl>)> &cb) {
+			return providerManager.playUrl(opaqueSongId, cb, playUrlProvidersFor(providerId));
+		}, [this, audioKey, current, warmUpId](const Result<PlayUrl> &result) {
+			if (!result.ok)
+			{
+				Logger::debug(QStringLiteral("Warm up play url failed: %1").arg(result.error.message));
+				return;
+			}
+			cachePlayUrl(audioKey, result.value);
+			if (current && warmUpId == m_warmUpId && m_prefetchAudioBytes > 0)
+				audioCache.fetch(audioKey, result.value.url, RequestPriority::Prefetch, m_prefetchAudioBytes);
+		}));
+	});
+}
+
+void MusicController::keepWarmUpToken(const QString &key, const QSharedPointer<RequestToken> &token)
+{
+	if (!token)
+		return;
+	token->setPriority(RequestPriority::Prefetch);
+	m_warmUpTokens.append(qMakePair(key, token));
+}
+
+void MusicController::cancelWarmUp(const QStringList &keepKeys)
+{
+	++m_warmUpId;
+	// 正在播放的歌曲保留预热请求，由前台 joinBackgroundFetch 接管并提升优先级
+	const auto dropPending = [](auto &pending, const QString &key, const QSharedPointer<RequestToken> &token) {
+		const auto it = pending.constFind(key);
+		if (it != pending.constEnd() && it.value()->token == token)
+			pending.erase(it);
+	};
+	for (const auto &entry : std::as_const(m_warmUpTokens))
+	{
+		if (keepKeys.contains(entry.first))
+			continue;
+		entry.second->cancel();
+		dropPending(m_pendingPlayUrls, entry.first, entry.second);
+		dropPending(m_pendingLyrics, entry.first, entry.second);
+		dropPending(m_pendingCovers, entry.first, entry.second);
+	}
+	m_warmUpTokens.clear();
 }
 
 bool MusicController::loggedIn() const
@@ -2448,15 +3074,24 @@ void MusicController::loadFavoritePlaylist()
 	if (m_favoritePlaylistId.isEmpty()) return;
 
     // Load first 1000 tracks of favorite playlist
-    providerManager.playlistTracks(m_favoritePlaylistId, 1000, 0, [this](Result<PlaylistTracksPage> result) {
-        if (!result.ok) return;
-        
-        m_likedSongIds.clear();
-        for (const auto &s : result.value.songs) {
+    // 流式拉取：收藏状态随批次逐步更新，首批到达时清空旧集合
+    QSharedPointer<bool> cleared = QSharedPointer<bool>::create(false);
+    providerManager.playlistTracksStream(m_favoritePlaylistId, 1000, 0, [this, cleared](const QList<Song> &batch) {
+        if (!*cleared) {
+            *cleared = true;
+            m_likedSongIds.clear();
+        }
+        for (const auto &s : batch) {
             m_likedSongIds.insert(s.id);
             // Notify UI for each liked song so it can update state if displayed
             emit songLikeStateChanged(s.id, true);
         }
+    }, [this, cleared](Result<PlaylistTracksPage> result) {
+        // 歌单为空时不会有批次回调，这里补清空
+        if (result.ok && !*cleared) {
+            *cleared = true;
+            m_likedSongIds.clear();
+        }
     });
 }
 
@@ -2623,4 +3258,57 @@ QVariantList MusicController::countryCodes() const
     return m_countryCodes;
 }
 
+QVariantList MusicController::providerHealth() const
+{
+	QVariantList list;
+	const QList<ProviderHealth> health = providerManager.healthSnapshot();
+	for (const ProviderHealth &h : health)
+	{
+		QVariantMap m;
+		m.insert(QStringLiteral("providerId"), h.providerId);
+		m.insert(QStringLiteral("operation"), h.operation);
+		m.insert(QStringLiteral("state"), h.breaker.state);
+		m.insert(QStringLiteral("calls"), h.breaker.calls);
+		m.insert(QStringLiteral("failureRate"), h.breaker.failureRate);
+		m.insert(QStringLiteral("slowCallRate"), h.breaker.slowCallRate);
+		m.insert(QStringLiteral("averageLatencyMs"), h.breaker.averageLatencyMs);
+		m.insert(QStringLiteral("openRemainingMs"), h.breaker.openRemainingMs);
+		m.insert(QStringLiteral("score"), h.breaker.score);
+		list.append(m);
+	}
+	return list;
+}
+
+QVariantMap MusicController::networkDiagnostics() const
+{
+	const HttpSchedulerStats stats = httpClient.schedulerStats();
+	QVariantMap scheduler;
+	scheduler.insert(QStringLiteral("activeRequests"), stats.activeRequests);
+	scheduler.insert(QStringLiteral("queuedRequests"), stats.queuedRequests);
+	scheduler.insert(QStringLiteral("dispatchedTotal"), stats.dispatchedTotal);
+	scheduler.insert(QStringLiteral("queuedTotal"), stats.queuedTotal);
+	scheduler.insert(QStringLiteral("averageQueueWaitMs"), stats.averageQueueWaitMs);
+	scheduler.insert(QStringLiteral("maxQueueWaitMs"), stats.maxQueueWaitMs);
+
+	QVariantList caches;
+	const QList<ProviderCacheStats> cacheStats = providerManager.cacheStats();
+	for (const ProviderCacheStats &c : cacheStats)
+	{
+		QVariantMap m;
+		m.insert(QStringLiteral("name"), c.name);
+		m.insert(QStringLiteral("hits"), c.stats.hits);
+		m.insert(QStringLiteral("misses"), c.stats.misses);
+		m.insert(QStringLiteral("evictions"), c.stats.evictions);
+		m.insert(QStringLiteral("entries"), c.stats.entries);
+		m.insert(QStringLiteral("bytes"), c.stats.bytes);
+		m.insert(QStringLiteral("maxBytes"), c.stats.maxBytes);
+		caches.append(m);
+	}
+
+	QVariantMap result;
+	result.insert(QStringLiteral("scheduler"), scheduler);
+	result.insert(QStringLiteral("caches"), caches);
+	return result;
+}
+
 }
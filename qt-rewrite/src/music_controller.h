@@ -9,20 +9,34 @@
 #include <QSet>
 #include <QMap>
 
+#include "async_disk_cache.h"
+#include "audio_cache.h"
 #include "core_types.h"
+#include "cover_image_provider.h"
 #include "disk_cache.h"
 #include "http_client.h"
+#include "memory_cache.h"
 #include "lyric_list_model.h"
+#include "playback_clock.h"
 #include "playlist_list_model.h"
 #include "gdstudio_provider.h"
 #include "netease_provider.h"
 #include "qqmusic_provider.h"
 #include "provider_manager.h"
 #include "song_list_model.h"
+#include "unblock_worker.h"
 
 namespace App
 {
 
+// 后台（下一首预取、启动预热）发起且尚未返回的请求；当前歌曲需要同一资源时挂上去等待结果
+template <typename T>
+struct PendingFetch
+{
+	QSharedPointer<RequestToken> token;
+	QList<std::function<void(Result<T>)>> waiters;
+};
+
 class MusicController : public QObject
 {
 	Q_OBJECT
@@ -33,7 +47,9 @@ class MusicController : public QObject
 	Q_PROPERTY(QUrl currentUrl READ currentUrl NOTIFY currentUrlChanged)
 	Q_PROPERTY(bool playing READ playing NOTIFY playingChanged)
 	Q_PROPERTY(int volume READ volume WRITE setVolume NOTIFY volumeChanged)
+	// 只在同步点通知；需要逐帧平滑的位置由 QML 根据 playbackClock 外推
 	Q_PROPERTY(qint64 positionMs READ positionMs NOTIFY positionMsChanged)
+	Q_PROPERTY(PlaybackClock *playbackClock READ playbackClock CONSTANT)
 	Q_PROPERTY(qint64 durationMs READ durationMs NOTIFY durationMsChanged)
 	Q_PROPERTY(int currentSongIndex READ currentSongIndex NOTIFY currentSongIndexChanged)
 	Q_PROPERTY(int currentLyricIndex READ currentLyricIndex NOTIFY currentLyricIndexChanged)
@@ -87,6 +103,11 @@ public:
 	explicit MusicController(QObject *parent = nullptr);
 	~MusicController();
 
+	// 创建 image://cover 图片提供者，原图通过本控制器的封面接口下载；所有权交给 QML 引擎
+	CoverImageProvider *createCoverImageProvider();
+	// 界面首帧显示后调用：为恢复的当前歌曲及其后几首校验并预热封面、歌词缓存，解析播放地址
+	void startWarmUp();
+
 	int playbackMode() const;
 	void setPlaybackMode(int mode);
     
@@ -100,6 +121,7 @@ public:
 	int volume() const;
 	void setVolume(int v);
 	qint64 positionMs() const;
+	PlaybackClock *playbackClock();
 	qint64 durationMs() const;
 	int currentSongIndex() const;
 	int currentLyricIndex() const;
@@ -178,6 +200,10 @@ public:
 	Q_INVOKABLE void createPlaylist(const QString &name, const QString &type = "NORMAL", bool privacy = false);
 	Q_INVOKABLE void deletePlaylist(const QString &playlistIds);
 	Q_INVOKABLE void subscribePlaylist(const QString &playlistId, bool subscribe);
+	// 诊断：各来源 / 操作的熔断与健康状态
+	Q_INVOKABLE QVariantList providerHealth() const;
+	// 诊断：HTTP 请求调度（每主机并发上限由设置 maxConnectionsPerHost 控制）的排队统计，以及各结果内存缓存的命中统计
+	Q_INVOKABLE QVariantMap networkDiagnostics() const;
 	Q_INVOKABLE void togglePlaylistSubscribe();
 	Q_INVOKABLE void loadPlaylistTracks(const QString &playlistId);
 	Q_INVOKABLE void playAll();
@@ -261,14 +287,16 @@ private:
 	QQMusicProvider *qqMusicProvider = nullptr;
 	SongListModel m_songsModel;
 	LyricListModel m_lyricModel;
+	PlaybackClock m_clock;
 	SongListModel m_playlistModel;
 	SongListModel m_queueModel;
 	PlaylistListModel m_userPlaylistModel;
 	PlaylistListModel m_createdPlaylistModel;
 	PlaylistListModel m_collectedPlaylistModel;
 	QMediaPlayer m_player;
-    DiskCache imageCache;
-    DiskCache lyricCache;
+    AsyncDiskCache imageCache;
+    AsyncDiskCache lyricCache;
+	AudioCache audioCache;
     QSharedPointer<RequestToken> searchToken;
     QSharedPointer<RequestToken> m_currentSearchSuggestToken;
     QSharedPointer<RequestToken> m_hotSearchToken;
@@ -282,8 +310,11 @@ private:
 	QSharedPointer<RequestToken> loginToken;
 	QSharedPointer<RequestToken> importToken;
 	QProcess *musicApiProcess = nullptr;
+	UnblockWorker *unblockWorker = nullptr;
 	bool m_loading = false;
 	QUrl m_currentUrl;
+	// 播放远程地址时播放器读取的音频流，切换音源后释放
+	QPointer<AudioStream> m_playbackStream;
 	bool m_playing = false;
 	// 递增请求序号：用于在 UI 层丢弃过期回调，规避取消/竞态导致的错歌错图等问题
 	quint64 m_searchRequestId = 0;
@@ -327,7 +358,8 @@ private:
 	bool m_searchHasMore = false;
 
 	void setLoading(bool v);
-	void setCurrentUrl(const QUrl &url);
+	// stream 非空时播放器从音频流读取，url 仅作为音源标识
+	void setCurrentUrl(const QUrl &url, AudioStream *stream = nullptr);
 	void setPlaying(bool v);
 	void setPositionMs(qint64 v);
 	void setDurationMs(qint64 v);
@@ -343,18 +375,87 @@ private:
 	void updateCurrentLyricIndexByPosition(qint64 posMs);
 	void requestLyric(const QString &providerId, const QString &songId);
 	void requestCover(const QUrl &coverUrl);
+	void storeCoverImage(const QString &key, const QByteArray &data, const std::function<void(const QUrl &fileUrl)> &callback);
 	void clearLyric();
-	bool lyricFromCache(const QString &key, Lyric &outLyric);
+	void lyricFromCache(const QString &key, const std::function<void(const Lyric &lyric)> &callback);
 	void saveLyricToCache(const QString &key, const Lyric &lyric);
 	void handleMediaFinished();
 	void playNextInternal(bool fromUser);
 	void playPrevInternal(bool fromUser);
+
+	// 当前歌曲的播放地址上下文，播放器报错时据此刷新地址
+	struct CurrentPlayback
+	{
+		QString providerId;
+		QString opaqueSongId;
+		QString audioKey;
+		// 每次播放只自动刷新一次地址，避免反复失败时循环重试
+		bool urlRefreshed = false;
+	};
+	CurrentPlayback m_currentPlayback;
+	// 播放地址缓存：key 与音频缓存一致（来源 + 歌曲 id + 音质），有效期跟随地址的过期时间
+	MemoryCache<PlayUrl> playUrlCache{256, 5 * 60 * 1000};
+	void startPlayback(quint64 requestId, qint64 resumeAtMs);
+	void beginRemotePlayback(const QUrl &url, qint64 resumeAtMs);
+	void cachePlayUrl(const QString &key, const PlayUrl &playUrl);
+
+	// 下一首预取：当前歌曲播放到设定进度后，提前解析下一首的播放地址、下载音频开头并预热封面与歌词
+	struct NextPrefetch
+	{
+		// 触发预取时的播放序号，每次播放只触发一次
+		quint64 playRequestId = 0;
+		QString audioKey;
+		QString lyricKey;
+		QString coverKey;
+	};
+	NextPrefetch m_nextPrefetch;
+	QSharedPointer<RequestToken> prefetchUrlToken;
+	QSharedPointer<RequestToken> prefetchLyricToken;
+	QSharedPointer<RequestToken> prefetchCoverToken;
+	// 预取时已从网络拉取并写入缓存的歌词，切歌时无需再次刷新
+	QString m_prefetchedLyricKey;
+	// 随机模式下预先抽取的下一首，记录抽取时的当前序号与队列长度，变化后重新抽取；
+	// 切歌、队列变化与切换播放模式时清除，保证每次前进都是新的随机结果
+	int m_prerolledNextIndex = -1;
+	int m_prerolledFromIndex = -1;
+	int m_prerolledQueueCount = 0;
+	// 触发时机：播放进度达到该比例，或距结束不足 m_prefetchBeforeEndMs
+	double m_prefetchAtRatio = 0.7;
+	qint64 m_prefetchBeforeEndMs = 20000;
+	qint64 m_prefetchAudioBytes = 4LL * 1024 * 1024;
+	// 计算 playNextInternal 将要播放的序号；随机模式下会预抽并记住结果，实际切歌时沿用
+	int peekNextIndex();
+	void clearPrerolledNext();
+	void maybePrefetchNext(qint64 posMs);
+	void prefetchNext();
+	// 取消预取；切到的歌曲正是预取目标时，keepKeys 中对应的请求保留，由正式播放接管
+	void cancelPrefetch(const QStringList &keepKeys = QStringList());
+	void prefetchCover(const QUrl &coverUrl);
+	void prefetchLyric(const QString &providerId, const QString &songId);
+	// 进行中的后台请求，按与缓存相同的 key（播放地址：音频缓存 key；歌词：来源:歌曲 id；封面：规范 key）登记
+	QHash<QString, QSharedPointer<PendingFetch<PlayUrl>>> m_pendingPlayUrls;
+	QHash<QString, QSharedPointer<PendingFetch<Lyric>>> m_pendingLyrics;
+	QHash<QString, QSharedPointer<PendingFetch<QByteArray>>> m_pendingCovers;
+	// 发起后台请求并登记；onResult 先于挂上来的等待者执行（写缓存等）
+	template <typename T>
+	QSharedPointer<RequestToken> startBackgroundFetch(QHash<QString, QSharedPointer<PendingFetch<T>>> &pending, const QString &key, const std::function<QSharedPointer<RequestToken>(const std::function<void(Result<T>)> &)> &start, const std::function<void(const Result<T> &)> &onResult);
+	// 同一资源的后台请求仍在进行时提升其优先级并挂上等待者，返回其令牌；没有可用请求时返回空
+	template <typename T>
+	QSharedPointer<RequestToken> joinBackgroundFetch(QHash<QString, QSharedPointer<PendingFetch<T>>> &pending, const QString &key, RequestPriority priority, const std::function<void(Result<T>)> &waiter);
 	bool m_playlistHasMore = false;
 
 	// 队列持久化
 	void saveQueueToSettings();
 	void loadQueueFromSettings();
 
+	// 启动预热：使用预取优先级，开始播放时取消其余歌曲，正在播放的歌曲交由前台接管；m_warmUpId 用于丢弃取消后的回调
+	int m_warmUpCount = 3;
+	quint64 m_warmUpId = 0;
+	QList<QPair<QString, QSharedPointer<RequestToken>>> m_warmUpTokens;
+	void warmUpSong(const Song &song, bool current, quint64 warmUpId);
+	void keepWarmUpToken(const QString &key, const QSharedPointer<RequestToken> &token);
+	void cancelWarmUp(const QStringList &keepKeys = QStringList());
+
     // Lazy loading
     QSet<int> m_requestedPages;
     int m_lastRequestedPage = -1;
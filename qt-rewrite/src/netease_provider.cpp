@@ -5,10 +5,6 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QCoreApplication>
-#include <QDir>
-#include <QFileInfo>
-#include <QProcess>
 #include <QRegularExpression>
 #include <QSet>
 #include <QSettings>
@@ -18,10 +14,23 @@
 
 #include "logger.h"
 #include "json_utils.h"
+#include "lyric_parser.h"
 
 namespace App
 {
 
+namespace
+{
+
+// 接口的业务错误（如 400 / 502 / 8xx）也可能以 HTTP 200 返回，只有 code 为 200 的响应才写入缓存
+bool isApiSuccess(const HttpResponse &response)
+{
+	const QJsonDocument doc = QJsonDocument::fromJson(response.body);
+	return doc.isObject() && doc.object().value(QStringLiteral("code")).toInt() == 200;
+}
+
+}
+
 NeteaseProvider::NeteaseProvider(HttpClient *httpClient, const QUrl &baseUrl, QObject *parent)
 	: IProvider(parent)
 	, client(httpClient)
@@ -310,6 +319,12 @@ QString NeteaseProvider::displayName() const
 	return QStringLiteral("网易云音乐");
 }
 
+// 本地 API 与封面 CDN；接口返回的封面地址为 http，按 p1 / p2 等子域分布
+QList<QUrl> NeteaseProvider::warmUpOrigins() const
+{
+	return {apiBase, QUrl(QStringLiteral("http://p1.music.126.net")), QUrl(QStringLiteral("http://p2.music.126.net"))};
+}
+
 bool NeteaseProvider::supportsLyric() const
 {
 	return true;
@@ -340,6 +355,11 @@ QString NeteaseProvider::cookie() const
 	return m_cookie;
 }
 
+void NeteaseProvider::setUnblockWorker(UnblockWorker *worker)
+{
+	unblockWorker = worker;
+}
+
 QUrl NeteaseProvider::buildUrl(const QString &path, const QList<QPair<QString, QString>> &query) const
 {
 	QUrl url = apiBase.resolved(QUrl(path));
@@ -380,6 +400,8 @@ QSharedPointer<RequestToken> NeteaseProvider::searchSuggest(const QString &keywo
     QUrlQuery q(opts.url);
     q.addQueryItem(QStringLiteral("timestamp"), QString::number(QDateTime::currentMSecsSinceEpoch()));
     opts.url.setQuery(q);
+    // 联想词随输入很快过时，3 秒内拿不到结果就不再重试
+    opts.deadline = QDeadlineTimer(3000);
 
     return client->sendWithRetry(opts, 1, 500, [this, callback](Result<HttpResponse> result) {
         if (!result.ok) {
@@ -442,6 +464,10 @@ QSharedPointer<RequestToken> NeteaseProvider::hotSearch(const HotSearchCallback
     QUrlQuery query(opts.url);
     query.addQueryItem(QStringLiteral("timestamp"), QString::number(QDateTime::currentMSecsSinceEpoch()));
     opts.url.setQuery(query);
+    opts.cache.enabled = true;
+    opts.cache.ttlMs = 5 * 60 * 1000;
+    opts.cache.staleWhileRevalidateMs = 60 * 60 * 1000;
+    opts.cache.cacheIf = isApiSuccess;
 
     return client->sendWithRetry(opts, 1, 500, [this, callback](Result<HttpResponse> result) {
         if (!result.ok) {
@@ -501,6 +527,11 @@ QSharedPointer<RequestToken> NeteaseProvider::songDetail(const QString &songId,
 {
 	HttpRequestOptions opts;
 	opts.url = buildUrl(QStringLiteral("/song/detail"), {{QStringLiteral("ids"), songId}});
+	// 歌曲元数据几乎不变，长时间缓存
+	opts.cache.enabled = true;
+	opts.cache.ttlMs = 24 * 60 * 60 * 1000;
+	opts.cache.staleWhileRevalidateMs = 7 * 24 * 60 * 60 * 1000;
+	opts.cache.cacheIf = isApiSuccess;
 	return client->sendWithRetry(opts, 2, 500, [this, callback](Result<HttpResponse> result) {
 		if (!result.ok)
 		{
@@ -528,6 +559,13 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 		QObject::connect(token.data(), &RequestToken::cancelled, inner.data(), [inner]() {
 			inner->cancel();
 		});
+		// 外层优先级调整（如预取转为立即播放）同步到当前子请求
+		RequestToken *innerPtr = inner.data();
+		QObject::connect(token.data(), &RequestToken::priorityChanged, innerPtr, [innerPtr](RequestPriority priority) {
+			innerPtr->setPriority(priority);
+		});
+		if (token->hasPriority())
+			inner->setPriority(token->priority());
 	};
 
 	auto readQualityLevel = []() -> QString {
@@ -570,46 +608,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 		return enabled;
 	};
 
-	auto findMusicApiDir = []() -> QString {
-		QSettings settings;
-		settings.beginGroup(QStringLiteral("set"));
-		QString overrideDir = settings.value(QStringLiteral("musicApiDir"), QString()).toString().trimmed();
-		settings.endGroup();
-		if (!overrideDir.isEmpty())
-		{
-			QString dir = QDir::fromNativeSeparators(overrideDir);
-			if (QFileInfo::exists(QDir(dir).filePath(QStringLiteral("package.json"))))
-				return dir;
-		}
-
-		QByteArray envDir = qgetenv("QTREWRITE_MUSIC_API_DIR");
-		if (!envDir.isEmpty())
-		{
-			QString dir = QDir::fromNativeSeparators(QString::fromLocal8Bit(envDir));
-			if (QFileInfo::exists(QDir(dir).filePath(QStringLiteral("package.json"))))
-				return dir;
-		}
-
-		const QStringList roots = {QDir::currentPath(), QCoreApplication::applicationDirPath()};
-		for (const QString &root : roots)
-		{
-			QDir dir(root);
-			for (int depth = 0; depth < 10; ++depth)
-			{
-				QString candidate = dir.filePath(QStringLiteral("qt-rewrite/music-api"));
-				if (QFileInfo::exists(QDir(candidate).filePath(QStringLiteral("package.json"))))
-					return candidate;
-				candidate = dir.filePath(QStringLiteral("music-api"));
-				if (QFileInfo::exists(QDir(candidate).filePath(QStringLiteral("package.json"))))
-					return candidate;
-				if (!dir.cdUp())
-					break;
-			}
-		}
-		return QString();
-	};
-
-	auto startUnblockProcess = [this, songId, finish, token, readEnabledPlatforms, findMusicApiDir](const Song &song) {
+	auto startUnblockProcess = [this, songId, finish, token, readEnabledPlatforms](const Song &song) {
 		if (token->isCancelled())
 		{
 			Error e;
@@ -620,30 +619,16 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 			return;
 		}
 
-		Logger::debug(QStringLiteral("Start unblock process: songId=%1, name=%2")
+		Logger::debug(QStringLiteral("Start unblock match: songId=%1, name=%2")
 					 .arg(songId)
 					 .arg(song.name));
 
-		QString apiDir = findMusicApiDir();
-		if (apiDir.isEmpty())
+		if (!unblockWorker)
 		{
 			Error e;
 			e.category = ErrorCategory::UpstreamChange;
 			e.code = -1;
-			e.message = QStringLiteral("Embedded music API directory not found");
-			finish(Result<PlayUrl>::failure(e));
-			return;
-		}
-
-		QDir apiDirObj(apiDir);
-		QString unblockPkg = apiDirObj.filePath(QStringLiteral("node_modules/@unblockneteasemusic/server/package.json"));
-		if (!QFileInfo::exists(unblockPkg))
-		{
-			Error e;
-			e.category = ErrorCategory::UpstreamChange;
-			e.code = -1;
-			e.message = QStringLiteral("Embedded music API dependencies not installed");
-			e.detail = unblockPkg;
+			e.message = QStringLiteral("Unblock worker not available");
 			finish(Result<PlayUrl>::failure(e));
 			return;
 		}
@@ -663,145 +648,41 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 		album.insert(QStringLiteral("name"), song.album.name);
 		songData.insert(QStringLiteral("album"), album);
 
-		QJsonArray platforms;
-		for (const QString &p : readEnabledPlatforms())
-			platforms.append(p);
-
-		QString platformsJson = QString::fromUtf8(QJsonDocument(platforms).toJson(QJsonDocument::Compact));
-		QString songJson = QString::fromUtf8(QJsonDocument(songData).toJson(QJsonDocument::Compact));
-
-		QProcess *proc = new QProcess(token.data());
-		proc->setWorkingDirectory(apiDir);
-		proc->setProcessChannelMode(QProcess::SeparateChannels);
-
-		QString js = QStringLiteral(
-			"const mod=require('@unblockneteasemusic/server');"
-			"const match=mod.default||mod;"
-			"const w=(...a)=>process.stderr.write(a.map(x=>typeof x==='string'?x:JSON.stringify(x)).join(' ')+'\\n');"
-			"console.log=w;console.info=w;console.warn=w;console.error=w;"
-			"(async()=>{"
-			"const tail=process.argv.slice(-3);"
-			"const id=parseInt(tail[0],10);"
-			"let platforms;"
-			"try{platforms=JSON.parse(tail[1]||'[]');}catch(e){platforms=[];}"
-			"if(!Array.isArray(platforms)) platforms=[String(platforms)];"
-			"const song=JSON.parse(tail[2]||'{}');"
-			"const data=await match(id, platforms, song);"
-			"process.stdout.write(JSON.stringify(data||{}));"
-			"})().catch(e=>{console.error(e&&e.stack||e);process.exit(1);});"
-		);
-
-		proc->setProgram(QStringLiteral("node"));
-		proc->setArguments({QStringLiteral("-e"), js, songId, platformsJson, songJson});
-
-		QTimer *timer = new QTimer(proc);
-		timer->setSingleShot(true);
-		QObject::connect(timer, &QTimer::timeout, proc, [proc]() {
-			if (proc->state() != QProcess::NotRunning)
+		// 复用常驻 worker 进程，避免每首歌都重新启动 node 并加载依赖
+		QSharedPointer<RequestToken> matchToken = unblockWorker->match(songId, readEnabledPlatforms(), songData, [finish](Result<QJsonObject> result) {
+			if (!result.ok)
 			{
-				proc->kill();
+				finish(Result<PlayUrl>::failure(result.error));
+				return;
 			}
-		});
-		timer->start(12000);
 
-		QObject::connect(token.data(), &RequestToken::cancelled, proc, [proc]() {
-			if (proc->state() != QProcess::NotRunning)
-				proc->kill();
-		});
-
-		QObject::connect(proc, &QProcess::finished, proc, [proc, timer, finish](int exitCode, QProcess::ExitStatus exitStatus) {
-			timer->stop();
-			QByteArray out = proc->readAllStandardOutput();
-			QByteArray err = proc->readAllStandardError();
-			if (exitStatus != QProcess::NormalExit || exitCode != 0)
+			const QJsonObject o = result.value;
+			QString urlStr = o.value(QStringLiteral("url")).toString();
+			urlStr = urlStr.trimmed();
+			while (urlStr.startsWith('`') || urlStr.startsWith('"') || urlStr.startsWith('\''))
+				urlStr.remove(0, 1);
+			while (urlStr.endsWith('`') || urlStr.endsWith('"') || urlStr.endsWith('\''))
+				urlStr.chop(1);
+			urlStr = urlStr.trimmed();
+			if (urlStr.isEmpty())
 			{
-				QString errTail = QString::fromLocal8Bit(err).right(800);
-				Logger::warning(QStringLiteral("Unblock process failed: exitCode=%1, status=%2, stderr=%3")
-								.arg(exitCode)
-								.arg(static_cast<int>(exitStatus))
-								.arg(errTail));
 				Error e;
-				e.category = ErrorCategory::Unknown;
-				e.code = exitCode;
-				e.message = QStringLiteral("Unblock music failed");
-				e.detail = errTail;
+				e.category = ErrorCategory::UpstreamChange;
+				e.code = 404;
+				e.message = QStringLiteral("Play url not found");
 				finish(Result<PlayUrl>::failure(e));
-				proc->deleteLater();
 				return;
 			}
-
-		QJsonObject o;
-		QJsonDocument doc;
-		QJsonParseError pe{};
-		doc = QJsonDocument::fromJson(out, &pe);
-		if (pe.error == QJsonParseError::NoError && doc.isObject())
-			{
-			o = doc.object();
-			}
-		else
-		{
-			QByteArray raw = out;
-			int end = raw.lastIndexOf('}');
-			while (end > 0)
-			{
-				int start = raw.lastIndexOf('{', end);
-				if (start < 0)
-					break;
-				QByteArray candidate = raw.mid(start, end - start + 1);
-				if (!candidate.contains("\"url\""))
-				{
-					end = raw.lastIndexOf('}', start - 1);
-					continue;
-				}
-				QJsonParseError ce{};
-				QJsonDocument cdoc = QJsonDocument::fromJson(candidate, &ce);
-				if (ce.error == QJsonParseError::NoError && cdoc.isObject())
-				{
-					o = cdoc.object();
-					break;
-				}
-				end = raw.lastIndexOf('}', start - 1);
-			}
-		}
-
-		if (o.isEmpty())
-		{
-			Error e;
-			e.category = ErrorCategory::Parser;
-			e.code = -1;
-			e.message = QStringLiteral("Parse unblock result failed");
-			e.detail = QString::fromUtf8(out).right(800);
-			finish(Result<PlayUrl>::failure(e));
-			proc->deleteLater();
-			return;
-		}
-
-		QString urlStr = o.value(QStringLiteral("url")).toString();
-		urlStr = urlStr.trimmed();
-		while (urlStr.startsWith('`') || urlStr.startsWith('"') || urlStr.startsWith('\''))
-			urlStr.remove(0, 1);
-		while (urlStr.endsWith('`') || urlStr.endsWith('"') || urlStr.endsWith('\''))
-			urlStr.chop(1);
-		urlStr = urlStr.trimmed();
-		if (urlStr.isEmpty())
-		{
-			Error e;
-			e.category = ErrorCategory::UpstreamChange;
-			e.code = 404;
-			e.message = QStringLiteral("Play url not found");
-			finish(Result<PlayUrl>::failure(e));
-			proc->deleteLater();
-			return;
-		}
-		PlayUrl p;
-		p.url = QUrl(urlStr);
-		p.bitrate = o.value(QStringLiteral("br")).toInt();
-		p.size = static_cast<qint64>(o.value(QStringLiteral("size")).toDouble());
-		finish(Result<PlayUrl>::success(p));
-			proc->deleteLater();
+			PlayUrl p;
+			p.url = QUrl(urlStr);
+			p.bitrate = o.value(QStringLiteral("br")).toInt();
+			p.size = static_cast<qint64>(o.value(QStringLiteral("size")).toDouble());
+			p.strategy = QStringLiteral("unblock");
+			finish(Result<PlayUrl>::success(p));
+		});
+		QObject::connect(token.data(), &RequestToken::cancelled, matchToken.data(), [matchToken]() {
+			matchToken->cancel();
 		});
-
-		proc->start();
 	};
 
 	auto tryGdMusicOrUnblock = [this, finish, token, cancelIfOuterCancelled, startUnblockProcess, finished](const Song &song) {
@@ -867,6 +748,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 			HttpRequestOptions searchOpts;
 			searchOpts.url = searchUrl;
+			searchOpts.priority = RequestPriority::Playback;
 			searchOpts.timeoutMs = 5000;
 			QSharedPointer<RequestToken> searchToken = client->sendWithRetry(searchOpts, 1, 300, [this, base, source, searchQuery, finish, token, cancelIfOuterCancelled, startUnblockProcess, song, nextFn, finished](Result<HttpResponse> searchResult) {
 				if (token->isCancelled())
@@ -947,6 +829,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 				HttpRequestOptions urlOpts;
 				urlOpts.url = urlUrl;
+				urlOpts.priority = RequestPriority::Playback;
 				urlOpts.timeoutMs = 5000;
 				QSharedPointer<RequestToken> urlToken = client->sendWithRetry(urlOpts, 1, 300, [finish, token, nextFn, finished](Result<HttpResponse> urlResult) {
 					if (token->isCancelled())
@@ -982,6 +865,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 				p.url = QUrl(urlStr);
 				p.bitrate = o.value(QStringLiteral("br")).toVariant().toInt();
 				p.size = static_cast<qint64>(o.value(QStringLiteral("size")).toVariant().toLongLong());
+				p.strategy = QStringLiteral("gdstudio");
 				finish(Result<PlayUrl>::success(p));
 				});
 				cancelIfOuterCancelled(urlToken);
@@ -1013,6 +897,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 		HttpRequestOptions urlOpts;
 		urlOpts.url = urlUrl;
+		urlOpts.priority = RequestPriority::Playback;
 		urlOpts.timeoutMs = 5000;
 		QSharedPointer<RequestToken> urlToken = client->sendWithRetry(urlOpts, 1, 300, [finish, token, onFailed, finished](Result<HttpResponse> urlResult) {
 			if (token->isCancelled())
@@ -1048,6 +933,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 			p.url = QUrl(urlStr);
 			p.bitrate = o.value(QStringLiteral("br")).toVariant().toInt();
 			p.size = static_cast<qint64>(o.value(QStringLiteral("size")).toVariant().toLongLong());
+			p.strategy = QStringLiteral("gdstudio");
 			finish(Result<PlayUrl>::success(p));
 		});
 		cancelIfOuterCancelled(urlToken);
@@ -1055,6 +941,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 	HttpRequestOptions v1;
 	v1.url = buildUrl(QStringLiteral("/song/url/v1"), {{QStringLiteral("id"), songId}, {QStringLiteral("level"), readQualityLevel()}, {QStringLiteral("encodeType"), QStringLiteral("aac")}});
+	v1.priority = RequestPriority::Playback;
 	// 记录最近一次“非解析类”失败原因，避免最终只返回笼统 404
 	QSharedPointer<Error> lastError = QSharedPointer<Error>::create();
 	QSharedPointer<RequestToken> v1Token = client->sendWithRetry(v1, 2, 500, [this, songId, finish, token, cancelIfOuterCancelled, isUnblockEnabled, tryGdStudioDirectUrl, tryGdMusicOrUnblock, lastError, finished](Result<HttpResponse> result) {
@@ -1083,6 +970,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 		HttpRequestOptions legacy;
 		legacy.url = buildUrl(QStringLiteral("/song/url"), {{QStringLiteral("id"), songId}, {QStringLiteral("br"), QStringLiteral("320000")}});
+		legacy.priority = RequestPriority::Playback;
 		QSharedPointer<RequestToken> legacyToken = client->sendWithRetry(legacy, 1, 500, [this, songId, finish, token, cancelIfOuterCancelled, isUnblockEnabled, tryGdStudioDirectUrl, tryGdMusicOrUnblock, lastError, finished](Result<HttpResponse> legacyResult) {
 			if (token->isCancelled())
 				return;
@@ -1128,6 +1016,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playUrl(const QString &songId, con
 
 			HttpRequestOptions detail;
 			detail.url = buildUrl(QStringLiteral("/song/detail"), {{QStringLiteral("ids"), songId}});
+			detail.priority = RequestPriority::Playback;
 			QSharedPointer<RequestToken> detailToken = client->sendWithRetry(detail, 1, 500, [this, finish, token, tryGdStudioDirectUrl, tryGdMusicOrUnblock, failByLastErrorOrNotFound, finished](Result<HttpResponse> detailResult) {
 				if (token->isCancelled())
 					return;
@@ -1169,6 +1058,7 @@ QSharedPointer<RequestToken> NeteaseProvider::lyric(const QString &songId, const
 	QString firstUrlStr = firstUrl.toString(QUrl::FullyEncoded);
 	HttpRequestOptions opts;
 	opts.url = firstUrl;
+	opts.priority = RequestPriority::CurrentMedia;
 	QSharedPointer<RequestToken> first = client->sendWithRetry(opts, 2, 500, [this, songId, callback, token, firstUrlStr](Result<HttpResponse> result) {
 		if (token->isCancelled())
 			return;
@@ -1188,6 +1078,7 @@ QSharedPointer<RequestToken> NeteaseProvider::lyric(const QString &songId, const
 		QString legacyUrlStr = legacyUrl.toString(QUrl::FullyEncoded);
 		HttpRequestOptions legacy;
 		legacy.url = legacyUrl;
+		legacy.priority = RequestPriority::CurrentMedia;
 		QSharedPointer<RequestToken> second = client->sendWithRetry(legacy, 1, 500, [this, callback, token, legacyUrlStr](Result<HttpResponse> legacyResult) {
 			if (token->isCancelled())
 				return;
@@ -1214,6 +1105,7 @@ QSharedPointer<RequestToken> NeteaseProvider::cover(const QUrl &coverUrl, const
 {
 	HttpRequestOptions opts;
 	opts.url = coverUrl;
+	opts.priority = RequestPriority::CurrentMedia;
 	opts.headers.insert("Accept", "image/jpeg,image/png");
 	opts.timeoutMs = 15000;
 	return client->sendWithRetry(opts, 2, 500, [callback](Result<HttpResponse> result) {
@@ -1230,6 +1122,12 @@ QSharedPointer<RequestToken> NeteaseProvider::playlistDetail(const QString &play
 {
 	HttpRequestOptions opts;
 	opts.url = buildUrl(QStringLiteral("/playlist/detail"), {{QStringLiteral("id"), playlistId}});
+	// 歌单可能被编辑：短新鲜期 + 后台刷新，写操作后按标签失效
+	opts.cache.enabled = true;
+	opts.cache.ttlMs = 60 * 1000;
+	opts.cache.staleWhileRevalidateMs = 30 * 60 * 1000;
+	opts.cache.tag = QStringLiteral("playlist:") + playlistId;
+	opts.cache.cacheIf = isApiSuccess;
 	return client->sendWithRetry(opts, 2, 500, [this, callback](Result<HttpResponse> result) {
 		if (!result.ok)
 		{
@@ -1244,6 +1142,11 @@ QSharedPointer<RequestToken> NeteaseProvider::playlistTracks(const QString &play
 {
 	HttpRequestOptions opts;
 	opts.url = buildUrl(QStringLiteral("/playlist/track/all"), {{QStringLiteral("id"), playlistId}, {QStringLiteral("limit"), QString::number(limit > 0 ? limit : 50)}, {QStringLiteral("offset"), QString::number(offset > 0 ? offset : 0)}});
+	opts.cache.enabled = true;
+	opts.cache.ttlMs = 60 * 1000;
+	opts.cache.staleWhileRevalidateMs = 30 * 60 * 1000;
+	opts.cache.tag = QStringLiteral("playlist:") + playlistId;
+	opts.cache.cacheIf = isApiSuccess;
 	return client->sendWithRetry(opts, 2, 500, [this, playlistId, limit, offset, callback](Result<HttpResponse> result) {
 		if (!result.ok)
 		{
@@ -1254,6 +1157,64 @@ QSharedPointer<RequestToken> NeteaseProvider::playlistTracks(const QString &play
 	});
 }
 
+// 大歌单的响应体可达数 MB，流式请求边下载边解析 songs 数组，首批歌曲无需等待整个响应
+QSharedPointer<RequestToken> NeteaseProvider::playlistTracksStream(const QString &playlistId, int limit, int offset, const PlaylistTracksBatchCallback &onBatch, const PlaylistTracksCallback &callback)
+{
+	HttpRequestOptions opts;
+	opts.url = buildUrl(QStringLiteral("/playlist/track/all"), {{QStringLiteral("id"), playlistId}, {QStringLiteral("limit"), QString::number(limit > 0 ? limit : 50)}, {QStringLiteral("offset"), QString::number(offset > 0 ? offset : 0)}});
+	// 与 playlistTracks 使用相同的缓存策略，两者共享同一缓存条目与进行中的请求
+	opts.cache.enabled = true;
+	opts.cache.ttlMs = 60 * 1000;
+	opts.cache.staleWhileRevalidateMs = 30 * 60 * 1000;
+	opts.cache.tag = QStringLiteral("playlist:") + playlistId;
+	opts.cache.cacheIf = isApiSuccess;
+	QSharedPointer<Json::ArrayObjectScanner> scanner = QSharedPointer<Json::ArrayObjectScanner>::create(QStringLiteral("songs"));
+	QSharedPointer<QList<Song>> collected = QSharedPointer<QList<Song>>::create();
+	auto onChunk = [this, scanner, collected, onBatch](const QByteArray &chunk) {
+		const QList<QJsonObject> objects = scanner->feed(chunk);
+		if (objects.isEmpty())
+			return;
+		QList<Song> batch;
+		batch.reserve(objects.size());
+		for (const QJsonObject &o : objects)
+			batch.append(parseTrackObject(o));
+		collected->append(batch);
+		if (onBatch)
+			onBatch(batch);
+	};
+	return client->sendStreaming(opts, onChunk, [this, playlistId, limit, offset, scanner, collected, callback](Result<HttpResponse> result) {
+		if (!result.ok)
+		{
+			callback(Result<PlaylistTracksPage>::failure(result.error));
+			return;
+		}
+		// 非 2xx 响应不会被流式交付，body 仍完整保留
+		if (result.value.statusCode >= 400)
+		{
+			callback(parsePlaylistTracks(playlistId, limit, offset, result.value.body));
+			return;
+		}
+		Result<QJsonObject> root = scanner->skeleton();
+		if (!root.ok)
+		{
+			Error e = root.error;
+			e.message = QStringLiteral("Parse playlist tracks response failed");
+			callback(Result<PlaylistTracksPage>::failure(e));
+			return;
+		}
+		PlaylistTracksPage page;
+		page.playlistId = playlistId;
+		page.songs = *collected;
+		page.limit = limit > 0 ? limit : page.songs.size();
+		page.offset = offset > 0 ? offset : 0;
+		page.total = root.value.value(QStringLiteral("total")).toInt();
+		if (page.total <= 0)
+			page.total = page.offset + page.songs.size();
+		Logger::debug(QStringLiteral("Playlist %1 streamed %2 tracks").arg(playlistId).arg(page.songs.size()));
+		callback(Result<PlaylistTracksPage>::success(page));
+	});
+}
+
 Result<QList<Song>> NeteaseProvider::parseSearchSongs(const QByteArray &body) const
 {
 	auto adjustCover = [](const QUrl &u) {
@@ -1429,6 +1390,11 @@ Result<PlayUrl> NeteaseProvider::parsePlayUrl(const QByteArray &body) const
 	p.url = QUrl(urlStr);
 	p.bitrate = o.value(QStringLiteral("br")).toInt();
 	p.size = static_cast<qint64>(o.value(QStringLiteral("size")).toDouble());
+	p.strategy = QStringLiteral("netease");
+	// expi 为地址剩余有效期（秒）
+	const qint64 expi = static_cast<qint64>(o.value(QStringLiteral("expi")).toDouble());
+	if (expi > 0)
+		p.expiresAtMs = QDateTime::currentMSecsSinceEpoch() + expi * 1000;
 	return Result<PlayUrl>::success(p);
 }
 
@@ -1448,149 +1414,66 @@ Result<Lyric> NeteaseProvider::parseLyric(const QByteArray &body) const
 	QString rawLrc = root.value(QStringLiteral("lrc")).toObject().value(QStringLiteral("lyric")).toString();
 	QString rawTLrc = root.value(QStringLiteral("tlyric")).toObject().value(QStringLiteral("lyric")).toString();
 	QString rawYrc = root.value(QStringLiteral("yrc")).toObject().value(QStringLiteral("lyric")).toString();
+	QString rawRomaLrc = root.value(QStringLiteral("romalrc")).toObject().value(QStringLiteral("lyric")).toString();
+
+	// JSON 信息行（作词、作曲等）：{"t":0,"c":[{"tx":"..."}]}，各块文字拼成一行
+	auto appendFromObject = [](const QJsonObject &o, Lyric &lyric) {
+		qint64 t = static_cast<qint64>(o.value(QStringLiteral("t")).toVariant().toLongLong());
+		QJsonArray chunks = o.value(QStringLiteral("c")).toArray();
+		QString textLine;
+		textLine.reserve(64);
+		for (const QJsonValue &cv : chunks)
+		{
+			if (!cv.isObject())
+				continue;
+			QString tx = cv.toObject().value(QStringLiteral("tx")).toString();
+			if (!tx.isEmpty())
+				textLine.append(tx);
+		}
+		textLine = textLine.trimmed();
+		if (textLine.isEmpty())
+			return;
+		LyricLine ll;
+		ll.timeMs = t;
+		ll.text = textLine;
+		lyric.lines.append(ll);
+	};
 
-	auto parseYrcJson = [](const QString &text, Lyric &lyric) -> bool {
+	// 整段为 JSON 数组时一次解析；否则单遍逐行扫描，JSON 信息行按对象解析，其余行交给分词器
+	auto parseYrcJson = [&appendFromObject](QStringView text, Lyric &lyric) -> bool {
 		lyric.lines.clear();
+		lyric.words.clear();
 
-		auto appendFromObject = [&lyric](const QJsonObject &o) {
-			qint64 t = static_cast<qint64>(o.value(QStringLiteral("t")).toVariant().toLongLong());
-			QJsonArray chunks = o.value(QStringLiteral("c")).toArray();
-			QString textLine;
-			textLine.reserve(64);
-			for (const QJsonValue &cv : chunks)
-			{
-				if (!cv.isObject())
-					continue;
-				QString tx = cv.toObject().value(QStringLiteral("tx")).toString();
-				if (!tx.isEmpty())
-					textLine.append(tx);
-			}
-			textLine = textLine.trimmed();
-			if (textLine.isEmpty())
-				return;
-			LyricLine ll;
-			ll.timeMs = t;
-			ll.text = textLine;
-			lyric.lines.append(ll);
-		};
-
-		QJsonParseError ype{};
-		QJsonDocument ydoc = QJsonDocument::fromJson(text.toUtf8(), &ype);
-		if (ype.error == QJsonParseError::NoError)
+		const QStringView whole = text.trimmed();
+		if (whole.startsWith(QLatin1Char('[')) && whole.mid(1).trimmed().startsWith(QLatin1Char('{')))
 		{
-			if (ydoc.isArray())
+			QJsonParseError ype{};
+			QJsonDocument ydoc = QJsonDocument::fromJson(whole.toUtf8(), &ype);
+			if (ype.error == QJsonParseError::NoError && ydoc.isArray())
 			{
-				QJsonArray arr = ydoc.array();
+				const QJsonArray arr = ydoc.array();
 				for (const QJsonValue &v : arr)
 				{
-					if (!v.isObject())
-						continue;
-					appendFromObject(v.toObject());
+					if (v.isObject())
+						appendFromObject(v.toObject(), lyric);
 				}
 			}
-			else if (ydoc.isObject())
-			{
-				appendFromObject(ydoc.object());
-			}
 		}
 
 		if (lyric.lines.isEmpty())
 		{
-			QString s = text.trimmed();
-			int depth = 0;
-			int start = -1;
-			for (int i = 0; i < s.size(); ++i)
-			{
-				QChar ch = s.at(i);
-				if (ch == QLatin1Char('{'))
-				{
-					if (depth == 0)
-						start = i;
-					++depth;
-				}
-				else if (ch == QLatin1Char('}'))
+			LyricParser::forEachLine(text, [&appendFromObject, &lyric](QStringView line) {
+				const QStringView trimmed = line.trimmed();
+				if (trimmed.startsWith(QLatin1Char('{')))
 				{
-					if (depth > 0)
-						--depth;
-					if (depth == 0 && start >= 0)
-					{
-						QString objText = s.mid(start, i - start + 1);
-						QJsonParseError pe{};
-						QJsonDocument objDoc = QJsonDocument::fromJson(objText.toUtf8(), &pe);
-						if (pe.error == QJsonParseError::NoError && objDoc.isObject())
-							appendFromObject(objDoc.object());
-						start = -1;
-					}
-				}
-			}
-		}
-
-		{
-			QString normalized = text;
-			normalized.replace("\r\n", "\n");
-			normalized.replace("\r", "\n");
-			QStringList lines = normalized.split('\n');
-			QRegularExpression yrcHead(QStringLiteral("^\\[(\\d+)\\s*,\\s*(\\d+)\\]"));
-			QRegularExpression lrcHead(QStringLiteral("^\\[(\\d{1,2}):(\\d{2})(?:\\.(\\d{1,3}))?\\]"));
-			QRegularExpression chunk(QStringLiteral("\\([0-9]+\\s*,\\s*[0-9]+\\s*,\\s*[0-9]+\\)"));
-			for (const QString &line : lines)
-			{
-				QString l = line;
-				qint64 t = 0;
-				bool matched = false;
-				{
-					QRegularExpressionMatch hm = yrcHead.match(l);
-					if (hm.hasMatch())
-					{
-						t = static_cast<qint64>(hm.captured(1).toLongLong());
-						l.remove(yrcHead);
-						matched = true;
-					}
-				}
-				if (!matched)
-				{
-					QRegularExpressionMatch lm = lrcHead.match(l);
-					if (lm.hasMatch())
-					{
-						bool okMin = false;
-						bool okSec = false;
-						int minutes = lm.captured(1).toInt(&okMin);
-						int seconds = lm.captured(2).toInt(&okSec);
-						if (okMin && okSec)
-						{
-							int millis = 0;
-							QString msPart = lm.captured(3);
-							if (!msPart.isEmpty())
-							{
-								bool okMs = false;
-								int rawMs = msPart.toInt(&okMs);
-								if (okMs)
-								{
-									if (msPart.size() == 1)
-										millis = rawMs * 100;
-									else if (msPart.size() == 2)
-										millis = rawMs * 10;
-									else
-										millis = rawMs;
-								}
-							}
-							t = static_cast<qint64>(minutes) * 60000 + static_cast<qint64>(seconds) * 1000 + millis;
-							l.remove(lrcHead);
-							matched = true;
-						}
-					}
+					QJsonParseError pe{};
+					QJsonDocument objDoc = QJsonDocument::fromJson(trimmed.toUtf8(), &pe);
+					if (pe.error == QJsonParseError::NoError && objDoc.isObject())
+						appendFromObject(objDoc.object(), lyric);
+					return;
 				}
-				if (!matched)
-					continue;
-				l.remove(chunk);
-				QString trimmed = l.trimmed();
-				if (trimmed.isEmpty())
-					continue;
-				LyricLine ll;
-				ll.timeMs = t;
-				ll.text = trimmed;
-				lyric.lines.append(ll);
-			}
+				LyricParser::appendTimedLine(line, lyric);
+			});
 		}
 
 		if (lyric.lines.isEmpty())
@@ -1603,145 +1486,48 @@ Result<Lyric> NeteaseProvider::parseLyric(const QByteArray &body) const
 		return true;
 	};
 
-	if (!rawYrc.trimmed().isEmpty())
-	{
-		Lyric lyric;
-		if (parseYrcJson(rawYrc, lyric))
-		{
-			return Result<Lyric>::success(lyric);
-		}
-	}
-
-	if (rawLrc.trimmed().startsWith(QLatin1Char('{')) || rawLrc.trimmed().startsWith(QLatin1Char('[')))
-	{
-		Lyric lyric;
-		if (parseYrcJson(rawLrc, lyric))
-			return Result<Lyric>::success(lyric);
-	}
-
-	if (!rawLrc.isEmpty() && !rawTLrc.isEmpty())
-	{
-		QMap<QString, QString> original;
-		QMap<QString, QString> translated;
-		auto collect = [](const QString &text, QMap<QString, QString> &out) {
-			QString normalized = text;
-			normalized.replace("\r\n", "\n");
-			normalized.replace("\r", "\n");
-			QStringList lines = normalized.split('\n');
-			QRegularExpression re(QStringLiteral("\\[(\\d{1,2}:\\d{2}(?:\\.\\d{1,3})?)\\]"));
-			for (const QString &line : lines)
-			{
-				QRegularExpressionMatchIterator it = re.globalMatch(line);
-				QStringList tags;
-				int lastEnd = -1;
-				while (it.hasNext())
-				{
-					QRegularExpressionMatch m = it.next();
-					tags.append(QStringLiteral("[") + m.captured(1) + QStringLiteral("]"));
-					lastEnd = m.capturedEnd();
-				}
-				if (tags.isEmpty())
-					continue;
-				QString content = (lastEnd >= 0) ? line.mid(lastEnd).trimmed() : line.trimmed();
-				if (content.isEmpty())
-					continue;
-				for (const QString &tag : tags)
-					out.insert(tag, content);
-			}
-		};
-		collect(rawLrc, original);
-		collect(rawTLrc, translated);
-		QStringList merged;
-		merged.reserve(original.size() + translated.size());
-		for (auto it = original.cbegin(); it != original.cend(); ++it)
-		{
-			merged.append(it.key() + it.value());
-			auto tr = translated.constFind(it.key());
-			if (tr != translated.cend())
-				merged.append(it.key() + tr.value());
-		}
-		std::sort(merged.begin(), merged.end());
-		rawLrc = merged.join('\n');
-	}
+	// 原文：优先逐字歌词（yrc），其次 LRC
 	Lyric lyric;
-	QString normalized = rawLrc;
-	normalized.replace("\r\n", "\n");
-	normalized.replace("\r", "\n");
-	QStringList lines = normalized.split('\n');
-	bool anyTimestamp = false;
-	QRegularExpression re(QStringLiteral("\\[(\\d{1,2}):(\\d{2})(?:\\.(\\d{1,3}))?\\]"));
-	for (const QString &line : lines)
+	bool parsed = !rawYrc.trimmed().isEmpty() && parseYrcJson(rawYrc, lyric);
+	if (!parsed && (rawLrc.trimmed().startsWith(QLatin1Char('{')) || rawLrc.trimmed().startsWith(QLatin1Char('['))))
+		parsed = parseYrcJson(rawLrc, lyric);
+	if (!parsed)
 	{
-		QString trimmed = line.trimmed();
-		if (trimmed.isEmpty())
-			continue;
-		if (trimmed.startsWith(QLatin1Char('{')) || trimmed.startsWith(QLatin1Char('[')))
-		{
-			Lyric jsonLyric;
-			if (parseYrcJson(trimmed, jsonLyric) && !jsonLyric.lines.isEmpty())
-			{
-				for (const LyricLine &ll : jsonLyric.lines)
-				{
-					if (ll.timeMs > 0)
-						anyTimestamp = true;
-					lyric.lines.append(ll);
-				}
-				continue;
-			}
-		}
-		QRegularExpressionMatchIterator it = re.globalMatch(line);
-		QList<qint64> times;
-		int lastEnd = -1;
-		while (it.hasNext())
-		{
-			QRegularExpressionMatch m = it.next();
-			bool okMin = false;
-			bool okSec = false;
-			int minutes = m.captured(1).toInt(&okMin);
-			int seconds = m.captured(2).toInt(&okSec);
-			if (!okMin || !okSec)
-				continue;
-			int millis = 0;
-			QString msPart = m.captured(3);
-			if (!msPart.isEmpty())
+		lyric = Lyric();
+		bool anyTimestamp = false;
+		LyricParser::forEachLine(rawLrc, [&appendFromObject, &lyric, &anyTimestamp](QStringView line) {
+			const QStringView trimmed = line.trimmed();
+			if (trimmed.isEmpty())
+				return;
+			if (trimmed.startsWith(QLatin1Char('{')))
 			{
-				bool okMs = false;
-				int rawMs = msPart.toInt(&okMs);
-				if (okMs)
+				QJsonParseError pe{};
+				QJsonDocument objDoc = QJsonDocument::fromJson(trimmed.toUtf8(), &pe);
+				if (pe.error == QJsonParseError::NoError && objDoc.isObject())
 				{
-					if (msPart.size() == 1)
-						millis = rawMs * 100;
-					else if (msPart.size() == 2)
-						millis = rawMs * 10;
-					else
-						millis = rawMs;
+					const qsizetype before = lyric.lines.size();
+					appendFromObject(objDoc.object(), lyric);
+					if (lyric.lines.size() > before)
+					{
+						if (lyric.lines.last().timeMs > 0)
+							anyTimestamp = true;
+						return;
+					}
 				}
 			}
-			times.append(static_cast<qint64>(minutes) * 60000 + static_cast<qint64>(seconds) * 1000 + millis);
-			lastEnd = m.capturedEnd();
-		}
-		QString text = (lastEnd >= 0) ? line.mid(lastEnd).trimmed() : line.trimmed();
-		if (!times.isEmpty())
-		{
-			anyTimestamp = true;
-			for (qint64 t : times)
+			if (LyricParser::appendTimedLine(line, lyric))
 			{
-				LyricLine ll;
-				ll.timeMs = t;
-				ll.text = text;
-				lyric.lines.append(ll);
+				anyTimestamp = true;
+				return;
 			}
-		}
-		else
-		{
+			// 没有时间标签的纯文本行
 			LyricLine ll;
 			ll.timeMs = 0;
-			ll.text = text;
+			ll.text = trimmed.toString();
 			lyric.lines.append(ll);
-		}
-	}
-	if (anyTimestamp)
-	{
+		});
+		if (!anyTimestamp)
+			return Result<Lyric>::success(lyric);
 		std::sort(lyric.lines.begin(), lyric.lines.end(), [](const LyricLine &a, const LyricLine &b) {
 			if (a.timeMs != b.timeMs)
 				return a.timeMs < b.timeMs;
@@ -1757,6 +1543,11 @@ Result<Lyric> NeteaseProvider::parseLyric(const QByteArray &body) const
 		}
 		lyric.lines = deduped;
 	}
+
+	// 翻译与音译按毫秒时间并入对应的原文行；yrc 行首与 LRC 标签之间常有几百毫秒的偏差
+	constexpr qint64 kSecondarySkewMs = 500;
+	LyricParser::attachSecondary(lyric, rawTLrc, &LyricLine::translation, kSecondarySkewMs);
+	LyricParser::attachSecondary(lyric, rawRomaLrc, &LyricLine::romanization, kSecondarySkewMs);
 	return Result<Lyric>::success(lyric);
 }
 
@@ -1838,38 +1629,7 @@ Result<PlaylistTracksPage> NeteaseProvider::parsePlaylistTracks(const QString &p
 	QList<Song> songs;
 	songs.reserve(songsArr.size());
 	for (const QJsonValue &v : songsArr)
-	{
-		QJsonObject o = v.toObject();
-		Song s;
-		s.providerId = id();
-		s.source = id();
-		s.id = o.value(QStringLiteral("id")).toVariant().toString();
-		s.name = o.value(QStringLiteral("name")).toString();
-		QJsonArray artistArr = o.value(QStringLiteral("ar")).toArray();
-		for (const QJsonValue &av : artistArr)
-		{
-			QJsonObject ao = av.toObject();
-			Artist a;
-			a.id = ao.value(QStringLiteral("id")).toVariant().toString();
-			a.name = ao.value(QStringLiteral("name")).toString();
-			s.artists.append(a);
-		}
-		QJsonObject al = o.value(QStringLiteral("al")).toObject();
-		s.album.id = al.value(QStringLiteral("id")).toVariant().toString();
-		s.album.name = al.value(QStringLiteral("name")).toString();
-		{
-			QUrl u(al.value(QStringLiteral("picUrl")).toString());
-			if (!u.isEmpty())
-			{
-				QUrlQuery q;
-				q.addQueryItem(QStringLiteral("param"), QStringLiteral("300y300"));
-				u.setQuery(q);
-			}
-			s.album.coverUrl = u;
-		}
-		s.durationMs = o.value(QStringLiteral("dt")).toInteger();
-		songs.append(s);
-	}
+		songs.append(parseTrackObject(v.toObject()));
 	PlaylistTracksPage page;
 	page.playlistId = playlistId;
 	page.songs = songs;
@@ -1881,6 +1641,40 @@ Result<PlaylistTracksPage> NeteaseProvider::parsePlaylistTracks(const QString &p
 	return Result<PlaylistTracksPage>::success(page);
 }
 
+// 解析 playlist/track/all 返回的单首歌曲对象，整页解析与流式解析共用
+Song NeteaseProvider::parseTrackObject(const QJsonObject &o) const
+{
+	Song s;
+	s.providerId = id();
+	s.source = id();
+	s.id = o.value(QStringLiteral("id")).toVariant().toString();
+	s.name = o.value(QStringLiteral("name")).toString();
+	QJsonArray artistArr = o.value(QStringLiteral("ar")).toArray();
+	for (const QJsonValue &av : artistArr)
+	{
+		QJsonObject ao = av.toObject();
+		Artist a;
+		a.id = ao.value(QStringLiteral("id")).toVariant().toString();
+		a.name = ao.value(QStringLiteral("name")).toString();
+		s.artists.append(a);
+	}
+	QJsonObject al = o.value(QStringLiteral("al")).toObject();
+	s.album.id = al.value(QStringLiteral("id")).toVariant().toString();
+	s.album.name = al.value(QStringLiteral("name")).toString();
+	{
+		QUrl u(al.value(QStringLiteral("picUrl")).toString());
+		if (!u.isEmpty())
+		{
+			QUrlQuery q;
+			q.addQueryItem(QStringLiteral("param"), QStringLiteral("300y300"));
+			u.setQuery(q);
+		}
+		s.album.coverUrl = u;
+	}
+	s.durationMs = o.value(QStringLiteral("dt")).toInteger();
+	return s;
+}
+
 QSharedPointer<RequestToken> NeteaseProvider::loginQrKey(const LoginQrKeyCallback &callback)
 {
 	HttpRequestOptions opts;
@@ -2253,6 +2047,11 @@ QSharedPointer<RequestToken> NeteaseProvider::userPlaylist(const QString &uid, i
 {
 	HttpRequestOptions opts;
 	opts.url = buildUrl(QStringLiteral("/user/playlist"), {{QStringLiteral("uid"), uid}, {QStringLiteral("limit"), QString::number(limit > 0 ? limit : 30)}, {QStringLiteral("offset"), QString::number(offset > 0 ? offset : 0)}});
+	opts.cache.enabled = true;
+	opts.cache.ttlMs = 30 * 1000;
+	opts.cache.staleWhileRevalidateMs = 30 * 60 * 1000;
+	opts.cache.tag = QStringLiteral("userPlaylist");
+	opts.cache.cacheIf = isApiSuccess;
 	return client->sendWithRetry(opts, 2, 500, [this, callback](Result<HttpResponse> result) {
 		if (!result.ok)
 		{
@@ -2277,7 +2076,7 @@ QSharedPointer<RequestToken> NeteaseProvider::playlistTracksOp(const QString &op
     q.addQueryItem(QStringLiteral("timestamp"), QString::number(QDateTime::currentMSecsSinceEpoch()));
     opts.url.setQuery(q);
 
-    return client->sendWithRetry(opts, 2, 500, [this, callback](Result<HttpResponse> result) {
+    return client->sendWithRetry(opts, 2, 500, [this, playlistId, callback](Result<HttpResponse> result) {
         if (!result.ok) {
             Logger::error(QStringLiteral("Playlist tracks op network failed: %1").arg(result.error.message));
             callback(Result<bool>::failure(result.error));
@@ -2308,7 +2107,10 @@ QSharedPointer<RequestToken> NeteaseProvider::playlistTracksOp(const QString &op
             callback(Result<bool>::failure({ErrorCategory::UpstreamChange, code, root.value(QStringLiteral("message")).toString()}));
             return;
         }
-        
+
+        // 歌单内容变更后，本地缓存的歌单详情 / 曲目 / 用户歌单列表都需要失效
+        client->invalidateCache(QStringLiteral("playlist:") + playlistId);
+        client->invalidateCache(QStringLiteral("userPlaylist"));
         callback(Result<bool>::success(true));
     });
 }
@@ -2325,7 +2127,7 @@ QSharedPointer<RequestToken> NeteaseProvider::createPlaylist(const QString &name
     HttpRequestOptions opts;
     opts.url = buildUrl(QStringLiteral("/playlist/create"), query);
     
-    return client->sendWithRetry(opts, 1, 500, [callback](Result<HttpResponse> result) {
+    return client->sendWithRetry(opts, 1, 500, [this, callback](Result<HttpResponse> result) {
         if (!result.ok) {
             callback(Result<bool>::failure(result.error));
             return;
@@ -2341,6 +2143,7 @@ QSharedPointer<RequestToken> NeteaseProvider::createPlaylist(const QString &name
         QJsonObject root = doc.object();
         int code = root.value(QStringLiteral("code")).toInt();
         if (code == 200) {
+            client->invalidateCache(QStringLiteral("userPlaylist"));
             callback(Result<bool>::success(true));
         } else {
             QString msg = root.value(QStringLiteral("msg")).toString();
@@ -2358,7 +2161,7 @@ QSharedPointer<RequestToken> NeteaseProvider::deletePlaylist(const QString &play
     HttpRequestOptions opts;
     opts.url = buildUrl(QStringLiteral("/playlist/delete"), query);
     
-    return client->sendWithRetry(opts, 1, 500, [callback](Result<HttpResponse> result) {
+    return client->sendWithRetry(opts, 1, 500, [this, playlistIds, callback](Result<HttpResponse> result) {
         if (!result.ok) {
             callback(Result<bool>::failure(result.error));
             return;
@@ -2374,6 +2177,9 @@ QSharedPointer<RequestToken> NeteaseProvider::deletePlaylist(const QString &play
         QJsonObject root = doc.object();
         int code = root.value(QStringLiteral("code")).toInt();
         if (code == 200) {
+            client->invalidateCache(QStringLiteral("userPlaylist"));
+            for (const QString &id : playlistIds.split(QLatin1Char(','), Qt::SkipEmptyParts))
+                client->invalidateCache(QStringLiteral("playlist:") + id.trimmed());
             callback(Result<bool>::success(true));
         } else {
             QString msg = root.value(QStringLiteral("msg")).toString();
@@ -2392,7 +2198,7 @@ QSharedPointer<RequestToken> NeteaseProvider::subscribePlaylist(const QString &p
     HttpRequestOptions opts;
     opts.url = buildUrl(QStringLiteral("/playlist/subscribe"), query);
     
-    return client->sendWithRetry(opts, 1, 500, [callback](Result<HttpResponse> result) {
+    return client->sendWithRetry(opts, 1, 500, [this, playlistId, callback](Result<HttpResponse> result) {
         if (!result.ok) {
             callback(Result<bool>::failure(result.error));
             return;
@@ -2408,6 +2214,8 @@ QSharedPointer<RequestToken> NeteaseProvider::subscribePlaylist(const QString &p
         QJsonObject root = doc.object();
         int code = root.value(QStringLiteral("code")).toInt();
         if (code == 200) {
+            client->invalidateCache(QStringLiteral("userPlaylist"));
+            client->invalidateCache(QStringLiteral("playlist:") + playlistId);
             callback(Result<bool>::success(true));
         } else {
             QString msg = root.value(QStringLiteral("msg")).toString();
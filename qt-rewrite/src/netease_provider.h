@@ -2,6 +2,7 @@
 #pragma once
 
 #include <QObject>
+#include <QPointer>
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
@@ -9,6 +10,7 @@
 #include "core_types.h"
 #include "http_client.h"
 #include "provider.h"
+#include "unblock_worker.h"
 
 namespace App
 {
@@ -26,6 +28,7 @@ public:
 	// IProvider 接口实现
 	QString id() const override;
 	QString displayName() const override;
+	QList<QUrl> warmUpOrigins() const override;
 	bool supportsLyric() const override;
 	bool supportsCover() const override;
 	bool supportsPlaylistDetail() const override;
@@ -43,6 +46,8 @@ public:
 	QSharedPointer<RequestToken> cover(const QUrl &coverUrl, const CoverCallback &callback) override;
 	QSharedPointer<RequestToken> playlistDetail(const QString &playlistId, const PlaylistDetailCallback &callback) override;
 	QSharedPointer<RequestToken> playlistTracks(const QString &playlistId, int limit, int offset, const PlaylistTracksCallback &callback) override;
+	bool supportsPlaylistTracksStream() const override { return true; }
+	QSharedPointer<RequestToken> playlistTracksStream(const QString &playlistId, int limit, int offset, const PlaylistTracksBatchCallback &onBatch, const PlaylistTracksCallback &callback) override;
     
     bool supportsPlaylistTracksOp() const override { return true; }
     QSharedPointer<RequestToken> playlistTracksOp(const QString &op, const QString &playlistId, const QString &trackIds, const BoolCallback &callback) override;
@@ -64,6 +69,8 @@ public:
 
 	void setCookie(const QString &cookie);
 	QString cookie() const;
+	// 设置解灰使用的常驻 worker，由外部持有其生命周期
+	void setUnblockWorker(UnblockWorker *worker);
 
 	QSharedPointer<RequestToken> loginQrKey(const LoginQrKeyCallback &callback);
 	QSharedPointer<RequestToken> loginQrCreate(const QString &key, const LoginQrCreateCallback &callback);
@@ -93,6 +100,7 @@ private:
 	HttpClient *client;
 	QUrl apiBase;
 	QString m_cookie;
+	QPointer<UnblockWorker> unblockWorker;
 
 	QUrl buildUrl(const QString &path, const QList<QPair<QString, QString>> &query) const;
 	Result<QList<Song>> parseSearchSongs(const QByteArray &body) const;
@@ -101,6 +109,7 @@ private:
 	Result<Lyric> parseLyric(const QByteArray &body) const;
 	Result<PlaylistMeta> parsePlaylistDetail(const QByteArray &body) const;
 	Result<PlaylistTracksPage> parsePlaylistTracks(const QString &playlistId, int limit, int offset, const QByteArray &body) const;
+	Song parseTrackObject(const QJsonObject &o) const;
 	Result<LoginQrKey> parseLoginQrKey(const QByteArray &body) const;
 	Result<LoginQrCreate> parseLoginQrCreate(const QByteArray &body) const;
 	Result<LoginQrCheck> parseLoginQrCheck(const QByteArray &body) const;
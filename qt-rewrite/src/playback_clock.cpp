@@ -0,0 +1,88 @@
+// PlaybackClock 实现
+#include "playback_clock.h"
+
+#include <QDateTime>
+
+namespace App
+{
+
+namespace
+{
+
+// 外推位置与实际位置相差超过该值时重新同步（缓冲卡顿、音频设备时钟漂移等）
+constexpr qint64 kDriftToleranceMs = 80;
+// 即使没有偏差，也按该间隔重新同步一次，限制长时间外推的累积误差
+constexpr qint64 kResyncIntervalMs = 2000;
+
+}
+
+PlaybackClock::PlaybackClock(QObject *parent)
+	: QObject(parent)
+	, m_anchorWallMs(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+qint64 PlaybackClock::anchorPositionMs() const
+{
+	return m_anchorPositionMs;
+}
+
+qint64 PlaybackClock::anchorWallMs() const
+{
+	return m_anchorWallMs;
+}
+
+qreal PlaybackClock::rate() const
+{
+	return m_rate;
+}
+
+qint64 PlaybackClock::durationMs() const
+{
+	return m_durationMs;
+}
+
+void PlaybackClock::update(qint64 positionMs, qreal rate)
+{
+	++m_ticks;
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (rate != m_rate || now - m_anchorWallMs >= kResyncIntervalMs || qAbs(positionAt(now) - positionMs) > kDriftToleranceMs)
+		sync(positionMs, rate);
+}
+
+void PlaybackClock::sync(qint64 positionMs, qreal rate)
+{
+	m_anchorPositionMs = positionMs;
+	m_anchorWallMs = QDateTime::currentMSecsSinceEpoch();
+	m_rate = rate;
+	++m_syncs;
+	emit synced();
+}
+
+void PlaybackClock::setDurationMs(qint64 durationMs)
+{
+	if (m_durationMs == durationMs)
+		return;
+	m_durationMs = durationMs;
+	emit synced();
+}
+
+qint64 PlaybackClock::positionAt(qint64 wallMs) const
+{
+	qint64 pos = m_anchorPositionMs + static_cast<qint64>(m_rate * (wallMs - m_anchorWallMs));
+	if (m_durationMs > 0 && pos > m_durationMs)
+		pos = m_durationMs;
+	return qMax<qint64>(0, pos);
+}
+
+quint64 PlaybackClock::tickCount() const
+{
+	return m_ticks;
+}
+
+quint64 PlaybackClock::syncCount() const
+{
+	return m_syncs;
+}
+
+}
@@ -0,0 +1,51 @@
+// PlaybackClock：播放时钟，只在必要时发布同步点（位置、速率、系统时间），QML 在动画帧内据此外推当前位置
+#pragma once
+
+#include <QObject>
+
+namespace App
+{
+
+class PlaybackClock : public QObject
+{
+	Q_OBJECT
+	// 最近一次同步点；anchorWallMs 与 QML 的 Date.now() 使用同一时间基准
+	Q_PROPERTY(qint64 anchorPositionMs READ anchorPositionMs NOTIFY synced)
+	Q_PROPERTY(qint64 anchorWallMs READ anchorWallMs NOTIFY synced)
+	// 播放速率，暂停或停止时为 0
+	Q_PROPERTY(qreal rate READ rate NOTIFY synced)
+	Q_PROPERTY(qint64 durationMs READ durationMs NOTIFY synced)
+
+public:
+	explicit PlaybackClock(QObject *parent = nullptr);
+
+	qint64 anchorPositionMs() const;
+	qint64 anchorWallMs() const;
+	qreal rate() const;
+	qint64 durationMs() const;
+
+	// 播放器上报位置时调用：外推偏差超出容差、速率变化或距上次同步过久时才发布新的同步点
+	void update(qint64 positionMs, qreal rate);
+	// 立即发布同步点（跳转、暂停、切歌等）
+	void sync(qint64 positionMs, qreal rate);
+	void setDurationMs(qint64 durationMs);
+
+	// 按同步点外推 wallMs 时刻的播放位置，不超过总时长
+	Q_INVOKABLE qint64 positionAt(qint64 wallMs) const;
+	// 统计：收到的位置上报次数与发布的同步点次数
+	quint64 tickCount() const;
+	quint64 syncCount() const;
+
+signals:
+	void synced();
+
+private:
+	qint64 m_anchorPositionMs = 0;
+	qint64 m_anchorWallMs = 0;
+	qreal m_rate = 0;
+	qint64 m_durationMs = 0;
+	quint64 m_ticks = 0;
+	quint64 m_syncs = 0;
+};
+
+}
@@ -37,6 +37,8 @@ public:
 	virtual QString id() const = 0;
 	// Provider 展示名称，用于 UI 显示
 	virtual QString displayName() const = 0;
+	// 需要提前建立连接的上游地址（接口与图片 CDN），由 HttpClient 在启动与网络切换后预热
+	virtual QList<QUrl> warmUpOrigins() const { return {}; }
 
 	// 是否支持搜索能力，默认支持
 	virtual bool supportsSearch() const { return true; }
@@ -68,6 +70,8 @@ public:
 	using CoverCallback = std::function<void(Result<QByteArray>)>;
 	using PlaylistDetailCallback = std::function<void(Result<PlaylistMeta>)>;
 	using PlaylistTracksCallback = std::function<void(Result<PlaylistTracksPage>)>;
+	// 流式拉取歌单曲目时，每解析出一批歌曲回调一次
+	using PlaylistTracksBatchCallback = std::function<void(const QList<Song> &)>;
 	using BoolCallback = std::function<void(Result<bool>)>;
 
 	// 按关键字搜索歌曲，limit 控制最大返回条数，offset 控制偏移量
@@ -92,6 +96,13 @@ public:
 	virtual QSharedPointer<RequestToken> cover(const QUrl &coverUrl, const CoverCallback &callback) = 0;
 	virtual QSharedPointer<RequestToken> playlistDetail(const QString &playlistId, const PlaylistDetailCallback &callback) = 0;
 	virtual QSharedPointer<RequestToken> playlistTracks(const QString &playlistId, int limit, int offset, const PlaylistTracksCallback &callback) = 0;
+	// 流式拉取歌单曲目：歌曲边下载边通过 onBatch 交付，完成回调的 page 中包含全部歌曲与总数
+	virtual bool supportsPlaylistTracksStream() const { return false; }
+	virtual QSharedPointer<RequestToken> playlistTracksStream(const QString &playlistId, int limit, int offset, const PlaylistTracksBatchCallback &onBatch, const PlaylistTracksCallback &callback)
+	{
+		Q_UNUSED(playlistId); Q_UNUSED(limit); Q_UNUSED(offset); Q_UNUSED(onBatch); Q_UNUSED(callback);
+		return nullptr;
+	}
     
     virtual bool supportsPlaylistTracksOp() const { return false; }
     virtual QSharedPointer<RequestToken> playlistTracksOp(const QString &op, const QString &playlistId, const QString &trackIds, const BoolCallback &callback)
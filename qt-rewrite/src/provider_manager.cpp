@@ -4,13 +4,236 @@
 #include "http_client.h"
 #include "logger.h"
 
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <QTimer>
+
+#include <utility>
+
 namespace App
 {
 
+#ifdef QT_DEBUG
+namespace
+{
+
+// 基准测试用的同步 Provider：直接在调用栈内回调，测量的只有 fallback 执行器本身的开销
+class BenchProvider : public IProvider
+{
+public:
+	BenchProvider(const QString &providerId, bool failing, QObject *parent = nullptr)
+		: IProvider(parent)
+		, providerId(providerId)
+		, failing(failing)
+	{
+	}
+
+	QString id() const override { return providerId; }
+	QString displayName() const override { return providerId; }
+	QSharedPointer<RequestToken> search(const QString &, int, int, const SearchCallback &callback) override { return reply<QList<Song>>(callback); }
+	QSharedPointer<RequestToken> songDetail(const QString &, const SongDetailCallback &callback) override { return reply<Song>(callback); }
+	QSharedPointer<RequestToken> playUrl(const QString &, const PlayUrlCallback &callback) override { return reply<PlayUrl>(callback); }
+	QSharedPointer<RequestToken> lyric(const QString &, const LyricCallback &callback) override { return reply<Lyric>(callback); }
+	QSharedPointer<RequestToken> cover(const QUrl &, const CoverCallback &callback) override { return reply<QByteArray>(callback); }
+	QSharedPointer<RequestToken> playlistDetail(const QString &, const PlaylistDetailCallback &callback) override { return reply<PlaylistMeta>(callback); }
+	QSharedPointer<RequestToken> playlistTracks(const QString &, int, int, const PlaylistTracksCallback &callback) override { return reply<PlaylistTracksPage>(callback); }
+
+private:
+	QString providerId;
+	bool failing = false;
+
+	template <typename T>
+	QSharedPointer<RequestToken> reply(const std::function<void(Result<T>)> &callback)
+	{
+		if (failing)
+		{
+			Error e;
+			e.category = ErrorCategory::Network;
+			e.code = 1;
+			e.message = QStringLiteral("Bench failure");
+			callback(Result<T>::failure(e));
+		}
+		else
+		{
+			callback(Result<T>::success(T()));
+		}
+		return QSharedPointer<RequestToken>::create();
+	}
+};
+
+// 旧实现的副本（State + 自引用的 nextFn，每次尝试两个 connect），仅用于对比；
+// 熔断器关闭时 observe 原样返回回调，这里省略。nextFn 自引用导致的泄漏保持原样
+QSharedPointer<RequestToken> legacySongDetail(const QList<IProvider *> &candidates, const QString &songId, const IProvider::SongDetailCallback &callback)
+{
+	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
+	struct State
+	{
+		int index = 0;
+		QSharedPointer<RequestToken> currentToken;
+		Error lastError;
+	};
+	QSharedPointer<State> state = QSharedPointer<State>::create();
+	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
+	*nextFn = [songId, candidates, callback, masterToken, state, nextFn]() {
+		if (masterToken->isCancelled())
+		{
+			if (state->currentToken)
+				state->currentToken->cancel();
+			return;
+		}
+		if (state->index >= candidates.size())
+		{
+			callback(Result<Song>::failure(state->lastError));
+			return;
+		}
+		IProvider *provider = candidates.at(state->index);
+		state->currentToken = provider->songDetail(songId, [callback, masterToken, state, nextFn, candidates](Result<Song> result) {
+			if (masterToken->isCancelled())
+				return;
+			if (result.ok || state->index >= candidates.size() - 1)
+			{
+				callback(result);
+				return;
+			}
+			state->lastError = result.error;
+			state->index++;
+			(*nextFn)();
+		});
+		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
+			if (state->currentToken)
+				state->currentToken->cancel();
+		});
+		QObject::connect(masterToken.data(), &RequestToken::priorityChanged, provider, [state](RequestPriority priority) {
+			if (state->currentToken)
+				state->currentToken->setPriority(priority);
+		});
+		if (state->currentToken && masterToken->hasPriority())
+			state->currentToken->setPriority(masterToken->priority());
+	};
+	(*nextFn)();
+	return masterToken;
+}
+
+// 测量每次 songDetail 调用的开销：首个 Provider 即成功 / 失败后回退一次，旧实现与新执行器各测一遍。
+// 新执行器的数字包含来源解析与结果缓存写入，旧实现副本不含，比较结果偏向旧实现
+void runFallbackBenchmark()
+{
+	constexpr int iterations = 20000;
+	ProviderManager manager;
+	IProvider *failing = new BenchProvider(QStringLiteral("bench-fail"), true, &manager);
+	IProvider *ok = new BenchProvider(QStringLiteral("bench-ok"), false, &manager);
+	manager.registerProvider(failing);
+	manager.registerProvider(ok);
+	ProviderManagerConfig cfg;
+	cfg.fallbackEnabled = true;
+	cfg.hedgingEnabled = false;
+	cfg.circuitBreakerEnabled = false;
+
+	int failed = 0;
+	auto measure = [&failed](const std::function<void(int, const IProvider::SongDetailCallback &)> &call) {
+		int succeeded = 0;
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < iterations; ++i)
+		{
+			call(i, [&succeeded](Result<Song> result) {
+				if (result.ok)
+					++succeeded;
+			});
+		}
+		const qint64 elapsed = timer.nsecsElapsed();
+		failed += iterations - succeeded;
+		return static_cast<double>(elapsed) / iterations;
+	};
+	auto current = [&manager](const QStringList &order) {
+		return [&manager, order](int i, const IProvider::SongDetailCallback &cb) {
+			// 每次使用不同的 id，避免命中结果缓存
+			manager.songDetail(QString::number(i), cb, order);
+		};
+	};
+	auto legacy = [](const QList<IProvider *> &candidates) {
+		return [candidates](int i, const IProvider::SongDetailCallback &cb) {
+			legacySongDetail(candidates, QString::number(i), cb);
+		};
+	};
+
+	manager.setConfig(cfg);
+	const double legacyDirect = measure(legacy({ok}));
+	const double legacyFallback = measure(legacy({failing, ok}));
+	const double direct = measure(current({QStringLiteral("bench-ok")}));
+	const double fallback = measure(current({QStringLiteral("bench-fail"), QStringLiteral("bench-ok")}));
+	Logger::info(QStringLiteral("Fallback bench: %1 calls, first provider ok %2 -> %3 ns/call, one fallback %4 -> %5 ns/call (legacy -> executor), %6 failed")
+					 .arg(iterations)
+					 .arg(legacyDirect, 0, 'f', 0)
+					 .arg(direct, 0, 'f', 0)
+					 .arg(legacyFallback, 0, 'f', 0)
+					 .arg(fallback, 0, 'f', 0)
+					 .arg(failed));
+}
+
+}
+#endif
+
+namespace
+{
+
+// 结果缓存的字节估算：按 UTF-16 字符串长度加上结构体本身，只求量级准确
+qint64 stringCost(const QString &s)
+{
+	return static_cast<qint64>(s.size()) * 2;
+}
+
+qint64 songCost(const Song &song)
+{
+	qint64 cost = sizeof(Song) + stringCost(song.providerId) + stringCost(song.source) + stringCost(song.id) + stringCost(song.name);
+	for (const Artist &a : song.artists)
+		cost += sizeof(Artist) + stringCost(a.id) + stringCost(a.name);
+	cost += stringCost(song.album.id) + stringCost(song.album.name) + song.album.coverUrl.toString().size() * 2;
+	return cost;
+}
+
+qint64 songListCost(const QList<Song> &songs)
+{
+	qint64 cost = sizeof(QList<Song>);
+	for (const Song &song : songs)
+		cost += songCost(song);
+	return cost;
+}
+
+qint64 lyricCost(const Lyric &lyric)
+{
+	qint64 cost = sizeof(Lyric);
+	for (const LyricLine &line : lyric.lines)
+		cost += sizeof(LyricLine) + stringCost(line.text) + stringCost(line.translation) + stringCost(line.romanization);
+	cost += lyric.words.size() * sizeof(LyricWord);
+	return cost;
+}
+
+qint64 playlistCost(const PlaylistMeta &meta)
+{
+	return sizeof(PlaylistMeta) + stringCost(meta.id) + stringCost(meta.name) + stringCost(meta.description) + stringCost(meta.creatorId) + meta.coverUrl.toString().size() * 2;
+}
+
+}
+
 // ProviderManager 构造函数，初始化默认配置
 ProviderManager::ProviderManager(QObject *parent)
 	: QObject(parent)
+	, songDetailCache(1024, 30 * 60 * 1000, 4LL * 1024 * 1024, songCost)
+	, lyricCache(128, 30 * 60 * 1000, 8LL * 1024 * 1024, lyricCost)
+	, playlistDetailCache(128, 5 * 60 * 1000, 1LL * 1024 * 1024, playlistCost)
+	, searchCache(64, 10 * 60 * 1000, 8LL * 1024 * 1024, songListCost)
 {
+#ifdef QT_DEBUG
+	// 设置 APP_SELFTEST_FALLBACK_BENCH 时在事件循环启动后运行一次执行器基准测试
+	static bool benchScheduled = false;
+	if (qEnvironmentVariableIsSet("APP_SELFTEST_FALLBACK_BENCH") && !benchScheduled)
+	{
+		benchScheduled = true;
+		QTimer::singleShot(0, this, []() { runFallbackBenchmark(); });
+	}
+#endif
 }
 
 // 注册 Provider，按 id 写入映射表
@@ -50,7 +273,7 @@ ProviderManagerConfig ProviderManager::config() const
 }
 
 // 解析 Provider 顺序并按谓词筛选
-QList<IProvider *> ProviderManager::resolveProviders(const QStringList &preferredProviderIds, std::function<bool(IProvider *)> predicate) const
+QList<IProvider *> ProviderManager::resolveProviders(const QStringList &preferredProviderIds, const QString &operation, std::function<bool(IProvider *)> predicate) const
 {
 	QList<IProvider *> result;
 	QStringList order;
@@ -70,9 +293,102 @@ QList<IProvider *> ProviderManager::resolveProviders(const QStringList &preferre
 			continue;
 		result.append(p);
 	}
+
+	// 熔断中的 Provider 移到末尾：其它来源都失败时仍可作为最后的尝试
+	if (operation.isEmpty() || !managerConfig.circuitBreakerEnabled || result.size() < 2)
+		return result;
+	QList<IProvider *> healthy;
+	QList<IProvider *> tripped;
+	for (IProvider *p : std::as_const(result))
+	{
+		auto it = breakers.constFind(breakerKey(p->id(), operation));
+		if (it == breakers.constEnd() || it->isCallPermitted())
+			healthy.append(p);
+		else
+			tripped.append(p);
+	}
+	if (!tripped.isEmpty())
+		Logger::debug(QStringLiteral("ProviderManager: %1 circuit open for %2").arg(operation).arg(tripped.first()->id()));
+	return healthy + tripped;
+}
+
+QString ProviderManager::breakerKey(const QString &providerId, const QString &operation)
+{
+	return providerId + QStringLiteral("/") + operation;
+}
+
+// 包装 Provider 回调：记录调用耗时与结果，驱动对应的熔断器
+template <typename T>
+std::function<void(Result<T>)> ProviderManager::observe(IProvider *provider, const QString &operation, const std::function<void(Result<T>)> &callback)
+{
+	if (operation.isEmpty() || !managerConfig.circuitBreakerEnabled)
+		return callback;
+	const QString key = breakerKey(provider->id(), operation);
+	breakers[key].onCallStarted();
+	const qint64 startedAt = QDateTime::currentMSecsSinceEpoch();
+	return [this, key, startedAt, callback](Result<T> result) {
+		recordOutcome(key, result.ok, result.error, QDateTime::currentMSecsSinceEpoch() - startedAt);
+		callback(result);
+	};
+}
+
+// 只有网络、限流与解析错误反映来源健康状况；“未找到”等业务结果视为正常响应
+void ProviderManager::recordOutcome(const QString &key, bool ok, const Error &error, qint64 latencyMs)
+{
+	CircuitBreaker &breaker = breakers[key];
+	const CircuitBreaker::State before = breaker.state();
+	const bool cancelled = error.category == ErrorCategory::Cancelled || (error.category == ErrorCategory::Network && error.code == -2);
+	if (!ok && cancelled)
+		breaker.recordIgnored();
+	else if (!ok && (error.category == ErrorCategory::Network || error.category == ErrorCategory::RateLimit || error.category == ErrorCategory::Parser))
+		breaker.recordFailure();
+	else
+		breaker.recordSuccess(latencyMs);
+	const CircuitBreaker::State after = breaker.state();
+	if (before != after)
+		Logger::info(QStringLiteral("ProviderManager: circuit %1 -> %2").arg(key).arg(breaker.snapshot().state));
+}
+
+// 返回所有熔断器的状态快照，按 Provider / 操作排序
+QList<ProviderHealth> ProviderManager::healthSnapshot() const
+{
+	QList<ProviderHealth> result;
+	QStringList keys = breakers.keys();
+	keys.sort();
+	for (const QString &key : std::as_const(keys))
+	{
+		const int sep = key.indexOf(QLatin1Char('/'));
+		ProviderHealth h;
+		h.providerId = key.left(sep);
+		h.operation = key.mid(sep + 1);
+		h.breaker = breakers.value(key).snapshot();
+		result.append(h);
+	}
 	return result;
 }
 
+QList<ProviderCacheStats> ProviderManager::cacheStats() const
+{
+	return {
+		{QStringLiteral("songDetail"), songDetailCache.stats()},
+		{QStringLiteral("lyric"), lyricCache.stats()},
+		{QStringLiteral("playlistDetail"), playlistDetailCache.stats()},
+		{QStringLiteral("search"), searchCache.stats()},
+	};
+}
+
+// 歌单详情、搜索结果等与登录用户相关，切换用户后不再沿用
+void ProviderManager::setCacheScope(const QString &scope)
+{
+	if (cacheScope == scope)
+		return;
+	cacheScope = scope;
+	songDetailCache.clear();
+	lyricCache.clear();
+	playlistDetailCache.clear();
+	searchCache.clear();
+}
+
 // 去重并保留 id 顺序
 QStringList ProviderManager::normalizeOrder(const QStringList &order) const
 {
@@ -88,10 +404,215 @@ QStringList ProviderManager::normalizeOrder(const QStringList &order) const
 	return normalized;
 }
 
+// 单次 fallback 调用的全部状态，整个调用只分配这一块
+template <typename T>
+struct ProviderManager::FallbackState
+{
+	QList<IProvider *> candidates;
+	QString operation;
+	int hedgeDelayMs = -1;
+	QDeadlineTimer deadline{QDeadlineTimer::Forever};
+	std::function<QSharedPointer<RequestToken>(IProvider *, const std::function<void(Result<T>)> &)> start;
+	std::function<void(Result<T>)> callback;
+	std::function<bool()> canFallback;
+	// 调用方可以丢弃返回的令牌（只关心回调），因此这里强引用外层令牌直到调用结束；
+	// 令牌上的连接捕获了 state，结束时断开连接并释放令牌以打破循环
+	QSharedPointer<RequestToken> master;
+	QList<QSharedPointer<RequestToken>> tokens;
+	QMetaObject::Connection cancelConnection;
+	QMetaObject::Connection priorityConnection;
+	int launched = 0;
+	int pending = 0;
+	int winner = -1;
+	bool done = false;
+	Error lastError;
+};
+
+// 统一的 fallback 执行器：顺序尝试候选，可选对冲；整个调用共享同一个截止时间
+template <typename T>
+QSharedPointer<RequestToken> ProviderManager::runFallback(const QList<IProvider *> &candidates, const QString &operation, int hedgeDelayMs, int deadlineMs, const std::function<QSharedPointer<RequestToken>(IProvider *, const std::function<void(Result<T>)> &)> &start, const std::function<void(Result<T>)> &callback, const std::function<bool()> &canFallback)
+{
+	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
+	QSharedPointer<FallbackState<T>> state = QSharedPointer<FallbackState<T>>::create();
+	state->candidates = managerConfig.fallbackEnabled ? candidates : candidates.mid(0, 1);
+	state->operation = operation;
+	state->hedgeDelayMs = (managerConfig.hedgingEnabled && managerConfig.fallbackEnabled) ? hedgeDelayMs : -1;
+	state->start = start;
+	state->callback = callback;
+	state->canFallback = canFallback;
+	state->master = masterToken;
+
+	// 外层令牌的取消与优先级只连接一次，调用结束时断开
+	state->cancelConnection = QObject::connect(masterToken.data(), &RequestToken::cancelled, masterToken.data(), [state]() {
+		if (state->done)
+			return;
+		state->done = true;
+		for (const QSharedPointer<RequestToken> &token : std::as_const(state->tokens))
+		{
+			if (token)
+				token->cancel();
+		}
+		QObject::disconnect(state->cancelConnection);
+		QObject::disconnect(state->priorityConnection);
+	});
+	state->priorityConnection = QObject::connect(masterToken.data(), &RequestToken::priorityChanged, masterToken.data(), [state](RequestPriority priority) {
+		for (const QSharedPointer<RequestToken> &token : std::as_const(state->tokens))
+		{
+			if (token)
+				token->setPriority(priority);
+		}
+	});
+
+	if (deadlineMs > 0)
+	{
+		state->deadline = QDeadlineTimer(deadlineMs);
+		QWeakPointer<FallbackState<T>> weak = state.toWeakRef();
+		QTimer::singleShot(deadlineMs, this, [this, weak]() {
+			QSharedPointer<FallbackState<T>> st = weak.toStrongRef();
+			if (st && !st->done)
+				finishFallback(st, Result<T>::failure(makeDeadlineError()), -1);
+		});
+	}
+
+	launchNext(state);
+	return masterToken;
+}
+
+template <typename T>
+void ProviderManager::launchNext(const QSharedPointer<FallbackState<T>> &state)
+{
+	if (state->done || state->launched >= state->candidates.size())
+		return;
+	if (state->deadline.hasExpired())
+	{
+		finishFallback(state, Result<T>::failure(makeDeadlineError()), -1);
+		return;
+	}
+	const int slot = state->launched++;
+	state->pending++;
+	state->tokens.append(QSharedPointer<RequestToken>());
+	IProvider *provider = state->candidates.at(slot);
+	if (slot > 0)
+		Logger::debug(QStringLiteral("ProviderManager: %1 %2 to %3").arg(state->operation, state->hedgeDelayMs >= 0 ? QStringLiteral("hedge") : QStringLiteral("fallback"), provider->id()));
+
+	QSharedPointer<RequestToken> token;
+	{
+		// Provider 内部发起的 HTTP 请求继承本次调用的截止时间
+		HttpDeadlineScope scope(state->deadline);
+		token = state->start(provider, observe<T>(provider, state->operation, [this, state, slot](Result<T> result) {
+			onAttemptResult(state, slot, result);
+		}));
+	}
+	state->tokens[slot] = token;
+	// 回调可能同步触发，此时胜负已定，需要补充取消
+	if (token)
+	{
+		if (state->done && state->winner != slot)
+			token->cancel();
+		else if (state->master && state->master->hasPriority())
+			token->setPriority(state->master->priority());
+	}
+
+	// 对冲：当前候选超过延迟仍未返回时提前启动下一个；期间已因失败启动过下一个时由新的候选重新计时
+	if (state->done || !state->master || state->hedgeDelayMs < 0 || state->launched != slot + 1 || state->launched >= state->candidates.size())
+		return;
+	if (state->hedgeDelayMs == 0)
+	{
+		launchNext(state);
+		return;
+	}
+	QWeakPointer<FallbackState<T>> weak = state.toWeakRef();
+	QTimer::singleShot(state->hedgeDelayMs, this, [this, weak, slot]() {
+		QSharedPointer<FallbackState<T>> st = weak.toStrongRef();
+		if (st && !st->done && st->launched == slot + 1)
+			launchNext(st);
+	});
+}
+
+template <typename T>
+void ProviderManager::onAttemptResult(const QSharedPointer<FallbackState<T>> &state, int slot, const Result<T> &result)
+{
+	if (state->done || !state->master || state->master->isCancelled())
+		return;
+	state->pending--;
+	if (result.ok)
+	{
+		finishFallback(state, result, slot);
+		return;
+	}
+	state->lastError = result.error;
+	const bool mayFallback = !state->canFallback || state->canFallback();
+	// 失败时不再等待对冲延迟，直接启动下一个候选
+	if (mayFallback && state->launched < state->candidates.size())
+	{
+		launchNext(state);
+		return;
+	}
+	if (!mayFallback || state->pending <= 0)
+		finishFallback(state, Result<T>::failure(state->lastError), -1);
+}
+
+template <typename T>
+void ProviderManager::finishFallback(const QSharedPointer<FallbackState<T>> &state, const Result<T> &result, int winner)
+{
+	if (state->done)
+		return;
+	state->done = true;
+	state->winner = winner;
+	for (int i = 0; i < state->tokens.size(); ++i)
+	{
+		if (i != winner && state->tokens.at(i))
+			state->tokens.at(i)->cancel();
+	}
+	QObject::disconnect(state->cancelConnection);
+	QObject::disconnect(state->priorityConnection);
+	// 回调返回后再释放外层令牌，回调内仍可安全访问调用方持有的同一令牌
+	const QSharedPointer<RequestToken> master = std::exchange(state->master, {});
+	if (!result.ok && result.error.code == static_cast<int>(QNetworkReply::TimeoutError) && state->deadline.hasExpired())
+		Logger::warning(QStringLiteral("ProviderManager: %1 deadline exceeded after %2 attempt(s)").arg(state->operation).arg(state->launched));
+	state->callback(result);
+}
+
+Error ProviderManager::makeDeadlineError()
+{
+	Error e;
+	e.category = ErrorCategory::Network;
+	e.code = static_cast<int>(QNetworkReply::TimeoutError);
+	e.message = QStringLiteral("Request timeout");
+	return e;
+}
+
+// 结果取决于候选来源，key 带上调用方指定的来源顺序
+QString ProviderManager::resultCacheKey(const QStringList &preferredProviderIds, const QString &args)
+{
+	return preferredProviderIds.join(QLatin1Char(',')) + QStringLiteral("|") + args;
+}
+
+template <typename T>
+QSharedPointer<RequestToken> ProviderManager::replyCached(const T &value, const std::function<void(Result<T>)> &callback)
+{
+	QSharedPointer<RequestToken> token = QSharedPointer<RequestToken>::create();
+	QTimer::singleShot(0, this, [token, callback, value]() {
+		if (!token->isCancelled())
+			callback(Result<T>::success(value));
+	});
+	return token;
+}
+
+template <typename T>
+std::function<void(Result<T>)> ProviderManager::storeOnSuccess(MemoryCache<T> &cache, const QString &key, const std::function<void(Result<T>)> &callback)
+{
+	return [&cache, key, callback](Result<T> result) {
+		if (result.ok)
+			cache.set(key, result.value);
+		callback(result);
+	};
+}
+
 // 搜索歌曲，按顺序尝试多个 Provider 并在失败时自动 fallback
 QSharedPointer<RequestToken> ProviderManager::search(const QString &keyword, int limit, int offset, const IProvider::SearchCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsSearch(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("search"), [](IProvider *p) { return p->supportsSearch(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -102,57 +623,19 @@ QSharedPointer<RequestToken> ProviderManager::search(const QString &keyword, int
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, keyword, limit, offset, candidates, callback, masterToken, state, nextFn]() {
-		// 若外层已取消，则不再继续
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		// 已经尝试完所有 Provider，则返回最后一次错误
-		if (state->index >= candidates.size())
-		{
-			callback(Result<QList<Song>>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->search(keyword, limit, offset, [this, callback, masterToken, state, nextFn, candidates](Result<QList<Song>> result) {
-			if (masterToken->isCancelled())
-				return;
-			// 成功或未启用 fallback 时直接返回
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			// 记录错误并尝试下一个 Provider
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		// 将外层取消与当前请求绑定
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-    return masterToken;
+	const QString key = resultCacheKey(preferredProviderIds, keyword + QStringLiteral("|") + QString::number(limit) + QStringLiteral("|") + QString::number(offset));
+	QList<Song> cached;
+	if (searchCache.get(key, cached))
+		return replyCached<QList<Song>>(cached, callback);
+
+	return runFallback<QList<Song>>(candidates, QStringLiteral("search"), managerConfig.searchHedgeDelayMs, managerConfig.fallbackDeadlineMs, [keyword, limit, offset](IProvider *p, const IProvider::SearchCallback &cb) {
+		return p->search(keyword, limit, offset, cb);
+	}, storeOnSuccess<QList<Song>>(searchCache, key, callback));
 }
 
 QSharedPointer<RequestToken> ProviderManager::searchSuggest(const QString &keyword, const IProvider::SearchSuggestCallback &callback, const QStringList &preferredProviderIds)
 {
-    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsSearchSuggest(); });
+    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("searchSuggest"), [](IProvider *p) { return p->supportsSearchSuggest(); });
     if (candidates.isEmpty())
     {
         Error e;
@@ -163,52 +646,14 @@ QSharedPointer<RequestToken> ProviderManager::searchSuggest(const QString &keywo
         return {};
     }
 
-    QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-    struct State
-    {
-        int index = 0;
-        QSharedPointer<RequestToken> currentToken;
-        Error lastError;
-    };
-    QSharedPointer<State> state = QSharedPointer<State>::create();
-    QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-    *nextFn = [this, keyword, candidates, callback, masterToken, state, nextFn]() {
-        if (masterToken->isCancelled())
-        {
-            if (state->currentToken)
-                state->currentToken->cancel();
-            return;
-        }
-        if (state->index >= candidates.size())
-        {
-            callback(Result<QStringList>::failure(state->lastError));
-            return;
-        }
-        IProvider *provider = candidates.at(state->index);
-        state->currentToken = provider->searchSuggest(keyword, [this, callback, masterToken, state, nextFn, candidates](Result<QStringList> result) {
-            if (masterToken->isCancelled())
-                return;
-            if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-            {
-                callback(result);
-                return;
-            }
-            state->lastError = result.error;
-            state->index++;
-            (*nextFn)();
-        });
-        QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-            if (state->currentToken)
-                state->currentToken->cancel();
-        });
-    };
-    (*nextFn)();
-    return masterToken;
+    return runFallback<QStringList>(candidates, QStringLiteral("searchSuggest"), -1, managerConfig.fallbackDeadlineMs, [keyword](IProvider *p, const IProvider::SearchSuggestCallback &cb) {
+        return p->searchSuggest(keyword, cb);
+    }, callback);
 }
 
 QSharedPointer<RequestToken> ProviderManager::hotSearch(const IProvider::HotSearchCallback &callback, const QStringList &preferredProviderIds)
 {
-    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsHotSearch(); });
+    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("hotSearch"), [](IProvider *p) { return p->supportsHotSearch(); });
     if (candidates.isEmpty())
     {
         Error e;
@@ -219,53 +664,15 @@ QSharedPointer<RequestToken> ProviderManager::hotSearch(const IProvider::HotSear
         return {};
     }
 
-    QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-    struct State
-    {
-        int index = 0;
-        QSharedPointer<RequestToken> currentToken;
-        Error lastError;
-    };
-    QSharedPointer<State> state = QSharedPointer<State>::create();
-    QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-    *nextFn = [this, candidates, callback, masterToken, state, nextFn]() {
-        if (masterToken->isCancelled())
-        {
-            if (state->currentToken)
-                state->currentToken->cancel();
-            return;
-        }
-        if (state->index >= candidates.size())
-        {
-            callback(Result<QList<HotSearchItem>>::failure(state->lastError));
-            return;
-        }
-        IProvider *provider = candidates.at(state->index);
-        state->currentToken = provider->hotSearch([this, callback, masterToken, state, nextFn, candidates](Result<QList<HotSearchItem>> result) {
-            if (masterToken->isCancelled())
-                return;
-            if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-            {
-                callback(result);
-                return;
-            }
-            state->lastError = result.error;
-            state->index++;
-            (*nextFn)();
-        });
-        QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-            if (state->currentToken)
-                state->currentToken->cancel();
-        });
-    };
-    (*nextFn)();
-    return masterToken;
+    return runFallback<QList<HotSearchItem>>(candidates, QStringLiteral("hotSearch"), -1, managerConfig.fallbackDeadlineMs, [](IProvider *p, const IProvider::HotSearchCallback &cb) {
+        return p->hotSearch(cb);
+    }, callback);
 }
 
 // 获取歌曲详情，支持多 Provider fallback
 QSharedPointer<RequestToken> ProviderManager::songDetail(const QString &songId, const IProvider::SongDetailCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsSongDetail(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("songDetail"), [](IProvider *p) { return p->supportsSongDetail(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -276,53 +683,20 @@ QSharedPointer<RequestToken> ProviderManager::songDetail(const QString &songId,
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, songId, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<Song>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->songDetail(songId, [this, callback, masterToken, state, nextFn, candidates](Result<Song> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	const QString key = resultCacheKey(preferredProviderIds, songId);
+	Song cached;
+	if (songDetailCache.get(key, cached))
+		return replyCached<Song>(cached, callback);
+
+	return runFallback<Song>(candidates, QStringLiteral("songDetail"), managerConfig.songDetailHedgeDelayMs, managerConfig.fallbackDeadlineMs, [songId](IProvider *p, const IProvider::SongDetailCallback &cb) {
+		return p->songDetail(songId, cb);
+	}, storeOnSuccess<Song>(songDetailCache, key, callback));
 }
 
 // 获取播放地址，支持多 Provider fallback
 QSharedPointer<RequestToken> ProviderManager::playUrl(const QString &songId, const IProvider::PlayUrlCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlayUrl(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("playUrl"), [](IProvider *p) { return p->supportsPlayUrl(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -333,53 +707,15 @@ QSharedPointer<RequestToken> ProviderManager::playUrl(const QString &songId, con
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, songId, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<PlayUrl>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->playUrl(songId, [this, callback, masterToken, state, nextFn, candidates](Result<PlayUrl> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	return runFallback<PlayUrl>(candidates, QStringLiteral("playUrl"), managerConfig.playUrlHedgeDelayMs, managerConfig.fallbackDeadlineMs, [songId](IProvider *p, const IProvider::PlayUrlCallback &cb) {
+		return p->playUrl(songId, cb);
+	}, callback);
 }
 
 // 获取歌词，支持多 Provider fallback
 QSharedPointer<RequestToken> ProviderManager::lyric(const QString &songId, const IProvider::LyricCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsLyric(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("lyric"), [](IProvider *p) { return p->supportsLyric(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -390,52 +726,19 @@ QSharedPointer<RequestToken> ProviderManager::lyric(const QString &songId, const
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, songId, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<Lyric>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->lyric(songId, [this, callback, masterToken, state, nextFn, candidates](Result<Lyric> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	const QString key = resultCacheKey(preferredProviderIds, songId);
+	Lyric cached;
+	if (lyricCache.get(key, cached))
+		return replyCached<Lyric>(cached, callback);
+
+	return runFallback<Lyric>(candidates, QStringLiteral("lyric"), managerConfig.lyricHedgeDelayMs, managerConfig.fallbackDeadlineMs, [songId](IProvider *p, const IProvider::LyricCallback &cb) {
+		return p->lyric(songId, cb);
+	}, storeOnSuccess<Lyric>(lyricCache, key, callback));
 }
 
 QSharedPointer<RequestToken> ProviderManager::cover(const QUrl &coverUrl, const IProvider::CoverCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsCover(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("cover"), [](IProvider *p) { return p->supportsCover(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -446,52 +749,14 @@ QSharedPointer<RequestToken> ProviderManager::cover(const QUrl &coverUrl, const
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, coverUrl, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<QByteArray>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->cover(coverUrl, [this, callback, masterToken, state, nextFn, candidates](Result<QByteArray> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	return runFallback<QByteArray>(candidates, QStringLiteral("cover"), -1, managerConfig.fallbackDeadlineMs, [coverUrl](IProvider *p, const IProvider::CoverCallback &cb) {
+		return p->cover(coverUrl, cb);
+	}, callback);
 }
 
 QSharedPointer<RequestToken> ProviderManager::playlistDetail(const QString &playlistId, const IProvider::PlaylistDetailCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistDetail(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("playlistDetail"), [](IProvider *p) { return p->supportsPlaylistDetail(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -502,52 +767,19 @@ QSharedPointer<RequestToken> ProviderManager::playlistDetail(const QString &play
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, playlistId, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<PlaylistMeta>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->playlistDetail(playlistId, [this, callback, masterToken, state, nextFn, candidates](Result<PlaylistMeta> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	const QString key = resultCacheKey(preferredProviderIds, playlistId);
+	PlaylistMeta cached;
+	if (playlistDetailCache.get(key, cached))
+		return replyCached<PlaylistMeta>(cached, callback);
+
+	return runFallback<PlaylistMeta>(candidates, QStringLiteral("playlistDetail"), -1, managerConfig.fallbackDeadlineMs, [playlistId](IProvider *p, const IProvider::PlaylistDetailCallback &cb) {
+		return p->playlistDetail(playlistId, cb);
+	}, storeOnSuccess<PlaylistMeta>(playlistDetailCache, key, callback));
 }
 
 QSharedPointer<RequestToken> ProviderManager::playlistTracks(const QString &playlistId, int limit, int offset, const IProvider::PlaylistTracksCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistTracks(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("playlistTracks"), [](IProvider *p) { return p->supportsPlaylistTracks(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -558,52 +790,53 @@ QSharedPointer<RequestToken> ProviderManager::playlistTracks(const QString &play
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
+	return runFallback<PlaylistTracksPage>(candidates, QStringLiteral("playlistTracks"), -1, managerConfig.fallbackDeadlineMs, [playlistId, limit, offset](IProvider *p, const IProvider::PlaylistTracksCallback &cb) {
+		return p->playlistTracks(playlistId, limit, offset, cb);
+	}, callback);
+}
+
+QSharedPointer<RequestToken> ProviderManager::playlistTracksStream(const QString &playlistId, int limit, int offset, const IProvider::PlaylistTracksBatchCallback &onBatch, const IProvider::PlaylistTracksCallback &callback, const QStringList &preferredProviderIds)
+{
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QStringLiteral("playlistTracks"), [](IProvider *p) { return p->supportsPlaylistTracks(); });
+	if (candidates.isEmpty())
 	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, playlistId, limit, offset, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
+		Error e;
+		e.category = ErrorCategory::UpstreamChange;
+		e.code = 404;
+		e.message = QStringLiteral("No providers available for playlist tracks");
+		callback(Result<PlaylistTracksPage>::failure(e));
+		return {};
+	}
+
+	// 已向调用方交付过歌曲，此后失败不能再换 Provider，否则会重复交付
+	QSharedPointer<bool> emitted = QSharedPointer<bool>::create(false);
+	return runFallback<PlaylistTracksPage>(candidates, QStringLiteral("playlistTracks"), -1, managerConfig.playlistStreamDeadlineMs, [playlistId, limit, offset, onBatch, emitted](IProvider *p, const IProvider::PlaylistTracksCallback &cb) {
+		if (p->supportsPlaylistTracksStream())
 		{
-			callback(Result<PlaylistTracksPage>::failure(state->lastError));
-			return;
+			return p->playlistTracksStream(playlistId, limit, offset, [onBatch, emitted](const QList<Song> &batch) {
+				if (batch.isEmpty())
+					return;
+				*emitted = true;
+				if (onBatch)
+					onBatch(batch);
+			}, cb);
 		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->playlistTracks(playlistId, limit, offset, [this, callback, masterToken, state, nextFn, candidates](Result<PlaylistTracksPage> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
+		// 不支持流式的 Provider 整页返回后作为一个批次交付
+		return p->playlistTracks(playlistId, limit, offset, [onBatch, emitted, cb](Result<PlaylistTracksPage> result) {
+			if (result.ok && !result.value.songs.isEmpty())
 			{
-				callback(result);
-				return;
+				*emitted = true;
+				if (onBatch)
+					onBatch(result.value.songs);
 			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
+			cb(result);
 		});
-	};
-	(*nextFn)();
-	return masterToken;
+	}, callback, [emitted]() { return !*emitted; });
 }
 
 QSharedPointer<RequestToken> ProviderManager::playlistTracksOp(const QString &op, const QString &playlistId, const QString &trackIds, const IProvider::BoolCallback &callback, const QStringList &preferredProviderIds)
 {
-	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistTracksOp(); });
+	QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QString(), [](IProvider *p) { return p->supportsPlaylistTracksOp(); });
 	if (candidates.isEmpty())
 	{
 		Error e;
@@ -614,179 +847,57 @@ QSharedPointer<RequestToken> ProviderManager::playlistTracksOp(const QString &op
 		return {};
 	}
 
-	QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-	struct State
-	{
-		int index = 0;
-		QSharedPointer<RequestToken> currentToken;
-		Error lastError;
-	};
-	QSharedPointer<State> state = QSharedPointer<State>::create();
-	QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-	*nextFn = [this, op, playlistId, trackIds, candidates, callback, masterToken, state, nextFn]() {
-		if (masterToken->isCancelled())
-		{
-			if (state->currentToken)
-				state->currentToken->cancel();
-			return;
-		}
-		if (state->index >= candidates.size())
-		{
-			callback(Result<bool>::failure(state->lastError));
-			return;
-		}
-		IProvider *provider = candidates.at(state->index);
-		state->currentToken = provider->playlistTracksOp(op, playlistId, trackIds, [this, callback, masterToken, state, nextFn, candidates](Result<bool> result) {
-			if (masterToken->isCancelled())
-				return;
-			if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1)
-			{
-				callback(result);
-				return;
-			}
-			state->lastError = result.error;
-			state->index++;
-			(*nextFn)();
-		});
-		QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-			if (state->currentToken)
-				state->currentToken->cancel();
-		});
-	};
-	(*nextFn)();
-	return masterToken;
+	// 曲目数等信息随之变化，歌单详情缓存整体失效
+	return runFallback<bool>(candidates, QString(), -1, 0, [op, playlistId, trackIds](IProvider *p, const IProvider::BoolCallback &cb) {
+		return p->playlistTracksOp(op, playlistId, trackIds, cb);
+	}, [this, callback](Result<bool> result) {
+		if (result.ok)
+			playlistDetailCache.clear();
+		callback(result);
+	});
 }
 
 QSharedPointer<RequestToken> ProviderManager::createPlaylist(const QString &name, const QString &type, bool privacy, const IProvider::BoolCallback &callback, const QStringList &preferredProviderIds)
 {
-    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistCreate(); });
+    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QString(), [](IProvider *p) { return p->supportsPlaylistCreate(); });
     if (candidates.isEmpty()) {
         callback(Result<bool>::failure({ErrorCategory::UpstreamChange, 404, QStringLiteral("No providers available for create playlist")}));
         return {};
     }
 
-    QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-    struct State {
-        int index = 0;
-        QSharedPointer<RequestToken> currentToken;
-        Error lastError;
-    };
-    QSharedPointer<State> state = QSharedPointer<State>::create();
-    QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-    *nextFn = [this, name, type, privacy, candidates, callback, masterToken, state, nextFn]() {
-        if (masterToken->isCancelled()) {
-            if (state->currentToken) state->currentToken->cancel();
-            return;
-        }
-        if (state->index >= candidates.size()) {
-            callback(Result<bool>::failure(state->lastError));
-            return;
-        }
-        IProvider *provider = candidates.at(state->index);
-        state->currentToken = provider->createPlaylist(name, type, privacy, [this, callback, masterToken, state, nextFn, candidates](Result<bool> result) {
-            if (masterToken->isCancelled()) return;
-            if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1) {
-                callback(result);
-                return;
-            }
-            state->lastError = result.error;
-            state->index++;
-            (*nextFn)();
-        });
-        QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-            if (state->currentToken) state->currentToken->cancel();
-        });
-    };
-    (*nextFn)();
-    return masterToken;
+    return runFallback<bool>(candidates, QString(), -1, 0, [name, type, privacy](IProvider *p, const IProvider::BoolCallback &cb) {
+        return p->createPlaylist(name, type, privacy, cb);
+    }, callback);
 }
 
 QSharedPointer<RequestToken> ProviderManager::deletePlaylist(const QString &playlistIds, const IProvider::BoolCallback &callback, const QStringList &preferredProviderIds)
 {
-    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistDelete(); });
+    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QString(), [](IProvider *p) { return p->supportsPlaylistDelete(); });
     if (candidates.isEmpty()) {
         callback(Result<bool>::failure({ErrorCategory::UpstreamChange, 404, QStringLiteral("No providers available for delete playlist")}));
         return {};
     }
 
-    QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-    struct State {
-        int index = 0;
-        QSharedPointer<RequestToken> currentToken;
-        Error lastError;
-    };
-    QSharedPointer<State> state = QSharedPointer<State>::create();
-    QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-    *nextFn = [this, playlistIds, candidates, callback, masterToken, state, nextFn]() {
-        if (masterToken->isCancelled()) {
-            if (state->currentToken) state->currentToken->cancel();
-            return;
-        }
-        if (state->index >= candidates.size()) {
-            callback(Result<bool>::failure(state->lastError));
-            return;
-        }
-        IProvider *provider = candidates.at(state->index);
-        state->currentToken = provider->deletePlaylist(playlistIds, [this, callback, masterToken, state, nextFn, candidates](Result<bool> result) {
-            if (masterToken->isCancelled()) return;
-            if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1) {
-                callback(result);
-                return;
-            }
-            state->lastError = result.error;
-            state->index++;
-            (*nextFn)();
-        });
-        QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-            if (state->currentToken) state->currentToken->cancel();
-        });
-    };
-    (*nextFn)();
-    return masterToken;
+    return runFallback<bool>(candidates, QString(), -1, 0, [playlistIds](IProvider *p, const IProvider::BoolCallback &cb) {
+        return p->deletePlaylist(playlistIds, cb);
+    }, callback);
 }
 
 QSharedPointer<RequestToken> ProviderManager::subscribePlaylist(const QString &playlistId, bool subscribe, const IProvider::BoolCallback &callback, const QStringList &preferredProviderIds)
 {
-    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, [](IProvider *p) { return p->supportsPlaylistSubscribe(); });
+    QList<IProvider *> candidates = resolveProviders(preferredProviderIds, QString(), [](IProvider *p) { return p->supportsPlaylistSubscribe(); });
     if (candidates.isEmpty()) {
         callback(Result<bool>::failure({ErrorCategory::UpstreamChange, 404, QStringLiteral("No providers available for subscribe playlist")}));
         return {};
     }
 
-    QSharedPointer<RequestToken> masterToken = QSharedPointer<RequestToken>::create();
-    struct State {
-        int index = 0;
-        QSharedPointer<RequestToken> currentToken;
-        Error lastError;
-    };
-    QSharedPointer<State> state = QSharedPointer<State>::create();
-    QSharedPointer<std::function<void()>> nextFn = QSharedPointer<std::function<void()>>::create();
-    *nextFn = [this, playlistId, subscribe, candidates, callback, masterToken, state, nextFn]() {
-        if (masterToken->isCancelled()) {
-            if (state->currentToken) state->currentToken->cancel();
-            return;
-        }
-        if (state->index >= candidates.size()) {
-            callback(Result<bool>::failure(state->lastError));
-            return;
-        }
-        IProvider *provider = candidates.at(state->index);
-        state->currentToken = provider->subscribePlaylist(playlistId, subscribe, [this, callback, masterToken, state, nextFn, candidates](Result<bool> result) {
-            if (masterToken->isCancelled()) return;
-            if (result.ok || !managerConfig.fallbackEnabled || state->index >= candidates.size() - 1) {
-                callback(result);
-                return;
-            }
-            state->lastError = result.error;
-            state->index++;
-            (*nextFn)();
-        });
-        QObject::connect(masterToken.data(), &RequestToken::cancelled, provider, [state]() {
-            if (state->currentToken) state->currentToken->cancel();
-        });
-    };
-    (*nextFn)();
-    return masterToken;
+    return runFallback<bool>(candidates, QString(), -1, 0, [playlistId, subscribe](IProvider *p, const IProvider::BoolCallback &cb) {
+        return p->subscribePlaylist(playlistId, subscribe, cb);
+    }, [this, callback](Result<bool> result) {
+        if (result.ok)
+            playlistDetailCache.clear();
+        callback(result);
+    });
 }
 
 }
@@ -1,6 +1,7 @@
 // ProviderManager：负责 Provider 注册、选择与失败回退策略
 #pragma once
 
+#include <QDeadlineTimer>
 #include <QHash>
 #include <QList>
 #include <QObject>
@@ -11,7 +12,9 @@
 
 #include <functional>
 
+#include "circuit_breaker.h"
 #include "core_types.h"
+#include "memory_cache.h"
 #include "provider.h"
 
 namespace App
@@ -24,6 +27,36 @@ struct ProviderManagerConfig
 	QStringList providerOrder;
 	// 是否启用失败自动 fallback
 	bool fallbackEnabled = true;
+	// 是否启用对冲请求：当前 Provider 超过阈值仍未返回时并行启动下一个，先成功者胜出
+	bool hedgingEnabled = false;
+	// 各操作的对冲延迟（毫秒），0 表示所有候选立即并行，-1 表示不对冲；只有调用方给出多个候选来源时才生效
+	int searchHedgeDelayMs = 1200;
+	int songDetailHedgeDelayMs = 1200;
+	int playUrlHedgeDelayMs = 0;
+	// 歌词只有网易云一个来源，没有可对冲的候选
+	int lyricHedgeDelayMs = -1;
+	// 是否启用按 Provider + 操作的熔断：持续失败或过慢的来源移到候选末尾，直到探测成功
+	bool circuitBreakerEnabled = true;
+	// 单次读取调用（含所有 fallback / 对冲尝试）的总截止时间，0 表示不限制；
+	// 写操作（歌单增删曲目、创建、删除、收藏）不设截止时间，避免放弃后服务端仍然生效
+	int fallbackDeadlineMs = 25000;
+	// 流式导入歌单逐批交付，总耗时随歌单长度增长，单独使用更长的截止时间
+	int playlistStreamDeadlineMs = 120000;
+};
+
+// 单个 Provider 某项操作的健康状态，用于诊断
+struct ProviderHealth
+{
+	QString providerId;
+	QString operation;
+	CircuitBreakerSnapshot breaker;
+};
+
+// 各类结果内存缓存的统计，用于诊断
+struct ProviderCacheStats
+{
+	QString name;
+	MemoryCacheStats stats;
 };
 
 // ProviderManager：统一管理多个音乐来源并提供 fallback 调度
@@ -46,6 +79,12 @@ public:
 	void setConfig(const ProviderManagerConfig &config);
 	// 获取当前配置快照
 	ProviderManagerConfig config() const;
+	// 各 Provider / 操作的熔断与健康状态快照
+	QList<ProviderHealth> healthSnapshot() const;
+	// 歌曲详情、歌词、歌单详情与搜索结果的内存缓存统计
+	QList<ProviderCacheStats> cacheStats() const;
+	// 设置缓存作用域（当前用户），变化时清空结果缓存
+	void setCacheScope(const QString &scope);
 
 	// 搜索歌曲，按配置顺序与 fallback 策略选择 Provider
     QSharedPointer<RequestToken> search(const QString &keyword, int limit, int offset, const IProvider::SearchCallback &callback, const QStringList &preferredProviderIds = {});
@@ -65,6 +104,8 @@ public:
 	QSharedPointer<RequestToken> playlistDetail(const QString &playlistId, const IProvider::PlaylistDetailCallback &callback, const QStringList &preferredProviderIds = {});
 	// 分页拉取歌单曲目，支持多 Provider fallback
 	QSharedPointer<RequestToken> playlistTracks(const QString &playlistId, int limit, int offset, const IProvider::PlaylistTracksCallback &callback, const QStringList &preferredProviderIds = {});
+	// 流式拉取歌单曲目：歌曲分批通过 onBatch 交付；已交付过数据后不再 fallback
+	QSharedPointer<RequestToken> playlistTracksStream(const QString &playlistId, int limit, int offset, const IProvider::PlaylistTracksBatchCallback &onBatch, const IProvider::PlaylistTracksCallback &callback, const QStringList &preferredProviderIds = {});
     
     // 歌单增删歌曲
     QSharedPointer<RequestToken> playlistTracksOp(const QString &op, const QString &playlistId, const QString &trackIds, const IProvider::BoolCallback &callback, const QStringList &preferredProviderIds = {});
@@ -79,10 +120,47 @@ private:
 	// 管理器配置，包括顺序与 fallback 开关
 	ProviderManagerConfig managerConfig;
 
-	// 根据配置与能力筛选候选 Provider 列表
-	QList<IProvider *> resolveProviders(const QStringList &preferredProviderIds, std::function<bool(IProvider *)> predicate) const;
+	// 熔断器：key 为 providerId/operation
+	QHash<QString, CircuitBreaker> breakers;
+
+	// 会话内结果缓存：key 为候选来源 + 参数，同一会话内重复访问直接从内存返回
+	MemoryCache<Song> songDetailCache;
+	MemoryCache<Lyric> lyricCache;
+	MemoryCache<PlaylistMeta> playlistDetailCache;
+	MemoryCache<QList<Song>> searchCache;
+	QString cacheScope;
+
+	// 根据配置与能力筛选候选 Provider 列表；operation 非空时熔断中的 Provider 排到末尾
+	QList<IProvider *> resolveProviders(const QStringList &preferredProviderIds, const QString &operation, std::function<bool(IProvider *)> predicate) const;
 	// 从 ProviderId 列表中去重并保留顺序
 	QStringList normalizeOrder(const QStringList &order) const;
+	static QString breakerKey(const QString &providerId, const QString &operation);
+	// 包装 Provider 回调以记录结果与耗时；operation 为空时原样返回
+	template <typename T>
+	std::function<void(Result<T>)> observe(IProvider *provider, const QString &operation, const std::function<void(Result<T>)> &callback);
+	void recordOutcome(const QString &key, bool ok, const Error &error, qint64 latencyMs);
+	// 统一的 fallback 执行器：按顺序尝试候选，失败即换下一个；hedgeDelayMs >= 0 且启用对冲时，
+	// 超过延迟未返回也并行启动下一个，首个成功结果返回，其余请求取消。
+	// 所有尝试共享 deadlineMs 截止时间（0 表示不限制），并通过 HttpDeadlineScope 传递给 Provider 内部请求；
+	// canFallback 返回 false 时失败不再换 Provider
+	template <typename T>
+	struct FallbackState;
+	template <typename T>
+	QSharedPointer<RequestToken> runFallback(const QList<IProvider *> &candidates, const QString &operation, int hedgeDelayMs, int deadlineMs, const std::function<QSharedPointer<RequestToken>(IProvider *, const std::function<void(Result<T>)> &)> &start, const std::function<void(Result<T>)> &callback, const std::function<bool()> &canFallback = std::function<bool()>());
+	template <typename T>
+	void launchNext(const QSharedPointer<FallbackState<T>> &state);
+	template <typename T>
+	void onAttemptResult(const QSharedPointer<FallbackState<T>> &state, int slot, const Result<T> &result);
+	template <typename T>
+	void finishFallback(const QSharedPointer<FallbackState<T>> &state, const Result<T> &result, int winner);
+	static Error makeDeadlineError();
+	static QString resultCacheKey(const QStringList &preferredProviderIds, const QString &args);
+	// 缓存命中时异步回调，与网络路径一致：调用方先拿到令牌，取消后不再回调
+	template <typename T>
+	QSharedPointer<RequestToken> replyCached(const T &value, const std::function<void(Result<T>)> &callback);
+	// 成功结果写入缓存后再交给调用方
+	template <typename T>
+	static std::function<void(Result<T>)> storeOnSuccess(MemoryCache<T> &cache, const QString &key, const std::function<void(Result<T>)> &callback);
 };
 
 }
@@ -16,6 +16,7 @@ public:
 
 	QString id() const override { return "qq"; }
 	QString displayName() const override { return "QQ Music"; }
+	QList<QUrl> warmUpOrigins() const override { return {apiBase}; }
 	bool supportsLyric() const override { return false; }
 	bool supportsCover() const override { return false; }
 	bool supportsPlaylistDetail() const override { return false; }
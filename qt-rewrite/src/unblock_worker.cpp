@@ -0,0 +1,347 @@
+// UnblockWorker 实现：管理常驻 node 进程的启动、请求复用、取消与崩溃重启
+#include "unblock_worker.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+
+#include "http_client.h"
+#include "logger.h"
+
+namespace App
+{
+
+namespace
+{
+
+// 连续崩溃超过该次数后不再自动重启，等待下一次请求再尝试拉起
+constexpr int kMaxAutoRestarts = 5;
+constexpr int kRestartBaseDelayMs = 500;
+constexpr int kRestartMaxDelayMs = 30000;
+
+Error makeCancelledError()
+{
+	Error e;
+	e.category = ErrorCategory::Network;
+	e.code = -2;
+	e.message = QStringLiteral("Request cancelled");
+	return e;
+}
+
+}
+
+UnblockWorker::UnblockWorker(const QString &musicApiDir, QObject *parent)
+	: QObject(parent)
+	, apiDir(musicApiDir)
+{
+}
+
+UnblockWorker::~UnblockWorker()
+{
+	stop();
+}
+
+QString UnblockWorker::scriptPath() const
+{
+	return QDir(apiDir).filePath(QStringLiteral("unblock_worker.js"));
+}
+
+// 检查运行环境，返回空字符串表示可以启动，否则返回错误描述
+QString UnblockWorker::checkEnvironment() const
+{
+	if (apiDir.isEmpty())
+		return QStringLiteral("Embedded music API directory not found");
+	QString unblockPkg = QDir(apiDir).filePath(QStringLiteral("node_modules/@unblockneteasemusic/server/package.json"));
+	if (!QFileInfo::exists(unblockPkg))
+		return QStringLiteral("Embedded music API dependencies not installed");
+	if (!QFileInfo::exists(scriptPath()))
+		return QStringLiteral("Unblock worker script not found");
+	return QString();
+}
+
+bool UnblockWorker::isRunning() const
+{
+	return process && process->state() != QProcess::NotRunning;
+}
+
+bool UnblockWorker::start()
+{
+	if (isRunning())
+		return true;
+	stopping = false;
+
+	QString envError = checkEnvironment();
+	if (!envError.isEmpty())
+	{
+		Logger::warning(QStringLiteral("Unblock worker not started: %1").arg(envError));
+		return false;
+	}
+
+	ready = false;
+	stdoutBuffer.clear();
+
+	QProcess *p = new QProcess(this);
+	p->setWorkingDirectory(apiDir);
+	p->setProcessChannelMode(QProcess::SeparateChannels);
+	p->setProgram(QStringLiteral("node"));
+	p->setArguments({scriptPath()});
+
+	QObject::connect(p, &QProcess::readyReadStandardOutput, this, [this, p]() {
+		if (p == process)
+			handleStdout();
+	});
+	QObject::connect(p, &QProcess::readyReadStandardError, this, [p]() {
+		QByteArray err = p->readAllStandardError();
+		if (!err.trimmed().isEmpty())
+			Logger::debug(QStringLiteral("Unblock worker: %1").arg(QString::fromLocal8Bit(err).trimmed().right(800)));
+	});
+	QObject::connect(p, &QProcess::finished, this, [this, p](int exitCode, QProcess::ExitStatus exitStatus) {
+		if (p != process)
+			return;
+		handleProcessGone(QStringLiteral("exitCode=%1, status=%2").arg(exitCode).arg(static_cast<int>(exitStatus)));
+	});
+	QObject::connect(p, &QProcess::errorOccurred, this, [this, p](QProcess::ProcessError error) {
+		// 其余错误之后都会收到 finished，只有启动失败需要在这里处理
+		if (p != process || error != QProcess::FailedToStart)
+			return;
+		handleProcessGone(p->errorString());
+	});
+
+	process = p;
+	Logger::info(QStringLiteral("Starting unblock worker in %1").arg(apiDir));
+	p->start();
+	return true;
+}
+
+void UnblockWorker::stop()
+{
+	stopping = true;
+	failAll(makeCancelledError());
+	queuedLines.clear();
+	ready = false;
+	if (!process)
+		return;
+	QProcess *p = process;
+	process = nullptr;
+	p->disconnect(this);
+	if (p->state() != QProcess::NotRunning)
+	{
+		// 关闭 stdin 后 worker 会自行退出，超时再强制结束
+		p->closeWriteChannel();
+		if (!p->waitForFinished(800))
+		{
+			p->kill();
+			p->waitForFinished(300);
+		}
+	}
+	delete p;
+}
+
+QSharedPointer<RequestToken> UnblockWorker::match(const QString &songId, const QStringList &platforms, const QJsonObject &songData, const MatchCallback &callback, int timeoutMs)
+{
+	QSharedPointer<RequestToken> token = QSharedPointer<RequestToken>::create();
+
+	QString envError = checkEnvironment();
+	if (!envError.isEmpty())
+	{
+		Error e;
+		e.category = ErrorCategory::UpstreamChange;
+		e.code = -1;
+		e.message = envError;
+		callback(Result<QJsonObject>::failure(e));
+		return token;
+	}
+	if (!isRunning() && !start())
+	{
+		Error e;
+		e.category = ErrorCategory::Unknown;
+		e.code = -1;
+		e.message = QStringLiteral("Unblock worker not available");
+		callback(Result<QJsonObject>::failure(e));
+		return token;
+	}
+
+	quint64 id = ++nextRequestId;
+	Pending entry;
+	entry.callback = callback;
+	QTimer *timer = new QTimer(this);
+	timer->setSingleShot(true);
+	QObject::connect(timer, &QTimer::timeout, this, [this, id]() {
+		if (!pending.contains(id))
+			return;
+		writeLine(QJsonObject{{QStringLiteral("id"), static_cast<qint64>(id)}, {QStringLiteral("op"), QStringLiteral("cancel")}});
+		Error e;
+		e.category = ErrorCategory::Network;
+		e.code = -1;
+		e.message = QStringLiteral("Unblock music timeout");
+		finishRequest(id, Result<QJsonObject>::failure(e));
+	});
+	timer->start(timeoutMs > 0 ? timeoutMs : 12000);
+	entry.timer = timer;
+	pending.insert(id, entry);
+
+	// 取消时通知 worker 丢弃结果，进程本身继续为其它请求服务
+	QObject::connect(token.data(), &RequestToken::cancelled, this, [this, id]() {
+		if (!pending.contains(id))
+			return;
+		writeLine(QJsonObject{{QStringLiteral("id"), static_cast<qint64>(id)}, {QStringLiteral("op"), QStringLiteral("cancel")}});
+		finishRequest(id, Result<QJsonObject>::failure(makeCancelledError()));
+	});
+
+	QJsonArray platformArr;
+	for (const QString &p : platforms)
+		platformArr.append(p);
+	QJsonObject request;
+	request.insert(QStringLiteral("id"), static_cast<qint64>(id));
+	request.insert(QStringLiteral("op"), QStringLiteral("match"));
+	request.insert(QStringLiteral("songId"), songId);
+	request.insert(QStringLiteral("platforms"), platformArr);
+	request.insert(QStringLiteral("song"), songData);
+	Logger::debug(QStringLiteral("Unblock worker request #%1: songId=%2").arg(id).arg(songId));
+	writeLine(request);
+	return token;
+}
+
+// 进程就绪前的请求先排队，避免写入尚未加载完依赖的进程
+void UnblockWorker::writeLine(const QJsonObject &message)
+{
+	QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+	line.append('\n');
+	if (!ready || !process)
+	{
+		queuedLines.append(line);
+		return;
+	}
+	process->write(line);
+}
+
+void UnblockWorker::handleStdout()
+{
+	stdoutBuffer.append(process->readAllStandardOutput());
+	int newline = stdoutBuffer.indexOf('\n');
+	while (newline >= 0)
+	{
+		QByteArray line = stdoutBuffer.left(newline).trimmed();
+		stdoutBuffer.remove(0, newline + 1);
+		newline = stdoutBuffer.indexOf('\n');
+		// 依赖库可能绕过 console 直接写 fd，非协议行直接忽略
+		if (!line.startsWith('{'))
+			continue;
+		QJsonParseError pe{};
+		QJsonDocument doc = QJsonDocument::fromJson(line, &pe);
+		if (pe.error != QJsonParseError::NoError || !doc.isObject())
+			continue;
+		handleMessage(doc.object());
+		if (!process)
+			return;
+	}
+}
+
+void UnblockWorker::handleMessage(const QJsonObject &message)
+{
+	if (message.value(QStringLiteral("ready")).toBool())
+	{
+		ready = true;
+		crashCount = 0;
+		Logger::info(QStringLiteral("Unblock worker ready"));
+		const QList<QByteArray> lines = queuedLines;
+		queuedLines.clear();
+		for (const QByteArray &line : lines)
+			process->write(line);
+		return;
+	}
+
+	quint64 id = message.value(QStringLiteral("id")).toVariant().toULongLong();
+	if (!pending.contains(id))
+		return;
+	if (message.value(QStringLiteral("ok")).toBool())
+	{
+		finishRequest(id, Result<QJsonObject>::success(message.value(QStringLiteral("data")).toObject()));
+		return;
+	}
+	QString errText = message.value(QStringLiteral("error")).toString();
+	Logger::warning(QStringLiteral("Unblock match failed: %1").arg(errText.right(800)));
+	Error e;
+	e.category = ErrorCategory::Unknown;
+	e.code = -1;
+	e.message = QStringLiteral("Unblock music failed");
+	e.detail = errText.right(800);
+	finishRequest(id, Result<QJsonObject>::failure(e));
+}
+
+void UnblockWorker::handleProcessGone(const QString &reason)
+{
+	QProcess *p = process;
+	process = nullptr;
+	ready = false;
+	stdoutBuffer.clear();
+	queuedLines.clear();
+	if (p)
+	{
+		p->disconnect(this);
+		p->deleteLater();
+	}
+
+	Logger::warning(QStringLiteral("Unblock worker exited: %1").arg(reason));
+	Error e;
+	e.category = ErrorCategory::Unknown;
+	e.code = -1;
+	e.message = QStringLiteral("Unblock music failed");
+	e.detail = reason;
+	failAll(e);
+
+	if (stopping)
+		return;
+	++crashCount;
+	scheduleRestart();
+}
+
+// 指数退避重启；连续崩溃过多时停止自动重启，留给下一次请求按需拉起
+void UnblockWorker::scheduleRestart()
+{
+	if (restartScheduled)
+		return;
+	if (crashCount > kMaxAutoRestarts)
+	{
+		Logger::warning(QStringLiteral("Unblock worker crashed %1 times in a row, auto restart paused").arg(crashCount));
+		crashCount = 0;
+		return;
+	}
+	qint64 delay = kRestartBaseDelayMs;
+	for (int i = 1; i < crashCount && delay < kRestartMaxDelayMs; ++i)
+		delay *= 2;
+	delay = qMin<qint64>(delay, kRestartMaxDelayMs);
+	restartScheduled = true;
+	QTimer::singleShot(static_cast<int>(delay), this, [this]() {
+		restartScheduled = false;
+		if (!stopping && !isRunning())
+			start();
+	});
+}
+
+void UnblockWorker::finishRequest(quint64 id, const Result<QJsonObject> &result)
+{
+	auto it = pending.find(id);
+	if (it == pending.end())
+		return;
+	Pending entry = it.value();
+	pending.erase(it);
+	if (entry.timer)
+	{
+		entry.timer->stop();
+		entry.timer->deleteLater();
+	}
+	if (entry.callback)
+		entry.callback(result);
+}
+
+void UnblockWorker::failAll(const Error &error)
+{
+	const QList<quint64> ids = pending.keys();
+	for (quint64 id : ids)
+		finishRequest(id, Result<QJsonObject>::failure(error));
+}
+
+}
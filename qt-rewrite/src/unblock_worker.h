@@ -0,0 +1,81 @@
+// UnblockWorker：常驻的解灰 node 进程，按 JSON 行协议复用同一进程处理多个匹配请求
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+#include "core_types.h"
+
+class QTimer;
+
+namespace App
+{
+
+class RequestToken;
+
+class UnblockWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	// 匹配结果回调：成功时返回 match() 的原始结果对象
+	using MatchCallback = std::function<void(Result<QJsonObject>)>;
+
+	// musicApiDir 为内置 music-api 目录（包含 unblock_worker.js 与 node_modules）
+	explicit UnblockWorker(const QString &musicApiDir, QObject *parent = nullptr);
+	~UnblockWorker() override;
+
+	// 启动常驻进程，已在运行时直接返回 true
+	bool start();
+	// 关闭常驻进程，并以取消错误结束所有未完成请求
+	void stop();
+	// 进程是否处于启动中或运行中
+	bool isRunning() const;
+
+	// 提交一次匹配请求，可通过返回的令牌取消；单个请求超时为 timeoutMs
+	QSharedPointer<RequestToken> match(const QString &songId, const QStringList &platforms, const QJsonObject &songData, const MatchCallback &callback, int timeoutMs = 12000);
+
+private:
+	// 单个进行中请求
+	struct Pending
+	{
+		MatchCallback callback;
+		QPointer<QTimer> timer;
+	};
+
+	QString apiDir;
+	QProcess *process = nullptr;
+	// stdout 中尚未凑成完整一行的数据
+	QByteArray stdoutBuffer;
+	// 进程尚未就绪前写入的请求行，就绪后统一发送
+	QList<QByteArray> queuedLines;
+	QHash<quint64, Pending> pending;
+	quint64 nextRequestId = 0;
+	bool ready = false;
+	bool stopping = false;
+	// 连续异常退出次数，用于重启退避
+	int crashCount = 0;
+	bool restartScheduled = false;
+
+	QString scriptPath() const;
+	QString checkEnvironment() const;
+	void writeLine(const QJsonObject &message);
+	void handleStdout();
+	void handleMessage(const QJsonObject &message);
+	void handleProcessGone(const QString &reason);
+	void scheduleRestart();
+	void finishRequest(quint64 id, const Result<QJsonObject> &result);
+	void failAll(const Error &error);
+};
+
+}